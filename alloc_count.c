@@ -0,0 +1,42 @@
+#include "alloc_count.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+/* Counting wrappers installed with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc */
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+static atomic_ulong allocations;
+static _Thread_local int excluded = 0;
+
+void *__wrap_malloc(size_t size)
+{
+    if (!excluded)
+        atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+    if (!excluded)
+        atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    if (!excluded)
+        atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __real_realloc(ptr, size);
+}
+
+unsigned long alloc_count(void)
+{
+    return atomic_load_explicit(&allocations, memory_order_relaxed);
+}
+
+void alloc_count_exclude_thread(void)
+{
+    excluded = 1;
+}
@@ -0,0 +1,22 @@
+#ifndef ALLOC_COUNT_H
+#define ALLOC_COUNT_H
+
+/**
+ * @brief Number of heap allocations made by the program so far.
+ *
+ * Only available in the allocation test build (`make surv-alloctest`),
+ * which links with `-Wl,--wrap` so that every malloc(), calloc() and
+ * realloc() call from the surv sources is counted. Allocations inside
+ * shared libraries (libc, ncurses) are not counted.
+ */
+unsigned long alloc_count(void);
+
+/**
+ * @brief Stops counting allocations made by the calling thread.
+ *
+ * For background threads that are not part of the frame loop, such as
+ * the scenario workload generator.
+ */
+void alloc_count_exclude_thread(void);
+
+#endif /* ALLOC_COUNT_H */
@@ -3,6 +3,8 @@
 #endif
 
 #include "checker.h"
+#include "sat.h"
+#include "trace.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
@@ -22,6 +24,13 @@ int numberOfOccupiedPixels = 0;
 objectList_T *objectPositions = NULL;
 /* Mutex protecting objectPositions and numberOfObjects */
 static pthread_mutex_t objectPositions_lock = PTHREAD_MUTEX_INITIALIZER;
+/* Node storage of the detected list, reused by every setDetectedObjects() */
+static objectList_T *detectedNodes = NULL;
+static int detectedCapacity = 0;
+
+/* Summed-area table of the latest frame, owned by the detection loop */
+static const coverageTable_T *coverageTable = NULL;
+static pthread_rwlock_t coverageTable_lock = PTHREAD_RWLOCK_INITIALIZER;
 
 /* Internal data structures */
 typedef struct internalObject_T
@@ -35,6 +44,18 @@ typedef struct internalObject_T
 static internalObject_T *obj_head = NULL;
 static internalObject_T *obj_tail = NULL;
 
+/* Objects are carved from slabs and recycled through a free list, so
+   large scenarios don't pay one malloc/free per object. Both are
+   protected by obj_lock. */
+#define OBJECT_SLAB_SIZE 4096
+typedef struct objectSlab_T
+{
+    struct objectSlab_T *next;
+    internalObject_T objects[OBJECT_SLAB_SIZE];
+} objectSlab_T;
+static objectSlab_T *obj_slabs = NULL;
+static internalObject_T *obj_free = NULL; /* linked through node.next */
+
 /* Synchronization primitives */
 static pthread_rwlock_t obj_lock;
 
@@ -43,10 +64,30 @@ static pthread_t timer_thread;
 static int timer_running = 0;
 static const unsigned int TIMER_MS = 100; /* 100 ms tick */
 
-/* Helper: add and remove objects (internal) */
+/* Helper: take an object from the pool; caller holds the write lock */
+static internalObject_T *alloc_internal_object(void)
+{
+    if (!obj_free)
+    {
+        objectSlab_T *slab = malloc(sizeof(*slab));
+        if (!slab)
+            return NULL;
+        slab->next = obj_slabs;
+        obj_slabs = slab;
+        for (int i = OBJECT_SLAB_SIZE - 1; i >= 0; --i)
+        {
+            slab->objects[i].node.next = (objectList_T *)obj_free;
+            obj_free = &slab->objects[i];
+        }
+    }
+    internalObject_T *o = obj_free;
+    obj_free = (internalObject_T *)o->node.next;
+    return o;
+}
+
+/* Helper: append an object to the list; caller holds the write lock */
 static void add_internal_object(internalObject_T *o)
 {
-    pthread_rwlock_wrlock(&obj_lock);
     o->node.prev = (objectList_T *)obj_tail;
     o->node.next = NULL;
     if (obj_tail)
@@ -55,23 +96,42 @@ static void add_internal_object(internalObject_T *o)
         obj_head = o;
     obj_tail = o;
     simNumberOfObjects++;
-    pthread_rwlock_unlock(&obj_lock);
 }
 
 /* Add a simulated object */
 int addObject(float sx, float zy, float vx, float vy)
 {
-    internalObject_T *o = malloc(sizeof(*o));
-    if (!o)
-        return -1;
-    o->node.object.s = sx;
-    o->node.object.z = zy;
-    o->vx = vx;
-    o->vy = vy;
-    o->node.next = NULL;
-    o->node.prev = NULL;
-    add_internal_object(o);
-    return 0;
+    simObject_T obj = {sx, zy, vx, vy};
+    return addObjects(&obj, 1) == 1 ? 0 : -1;
+}
+
+/* Add a batch of simulated objects under a single lock acquisition */
+int addObjects(const simObject_T *objs, int count)
+{
+    int added = 0;
+    pthread_rwlock_wrlock(&obj_lock);
+    for (; added < count; ++added)
+    {
+        internalObject_T *o = alloc_internal_object();
+        if (!o)
+            break;
+        o->node.object.s = objs[added].s;
+        o->node.object.z = objs[added].z;
+        o->vx = objs[added].vx;
+        o->vy = objs[added].vy;
+        add_internal_object(o);
+    }
+    pthread_rwlock_unlock(&obj_lock);
+    return added;
+}
+
+/* Number of simulated objects currently alive */
+unsigned int simulatedObjectCount(void)
+{
+    pthread_rwlock_rdlock(&obj_lock);
+    unsigned int n = simNumberOfObjects;
+    pthread_rwlock_unlock(&obj_lock);
+    return n;
 }
 
 /* Compute overlap area between two 1D intervals */
@@ -145,7 +205,8 @@ void updateObjectPosition(void)
                 obj_tail = (internalObject_T *)it->node.prev;
 
             simNumberOfObjects--;
-            free(it);
+            it->node.next = (objectList_T *)obj_free;
+            obj_free = it;
         }
         it = next;
     }
@@ -156,11 +217,14 @@ void updateObjectPosition(void)
 static void *timer_loop(void *arg)
 {
     (void)arg;
+    trace_thread_name("checker timer");
     while (timer_running)
     {
         struct timespec req = {.tv_sec = 0, .tv_nsec = (long)TIMER_MS * 1000000L};
         nanosleep(&req, NULL);
+        TRACE_BEGIN("timer_loop tick");
         updateObjectPosition();
+        TRACE_END("timer_loop tick");
     }
     return NULL;
 }
@@ -231,26 +295,22 @@ void checker_shutdown(void)
     }
 
     pthread_rwlock_wrlock(&obj_lock);
-    internalObject_T *it = obj_head;
-    while (it)
+    while (obj_slabs)
     {
-        internalObject_T *next = (internalObject_T *)it->node.next;
-        free(it);
-        it = next;
+        objectSlab_T *next = obj_slabs->next;
+        free(obj_slabs);
+        obj_slabs = next;
     }
+    obj_free = NULL;
     obj_head = obj_tail = NULL;
     simNumberOfObjects = 0;
     pthread_rwlock_unlock(&obj_lock);
 
     /* Clear detected object list */
     pthread_mutex_lock(&objectPositions_lock);
-    objectList_T *ot = objectPositions;
-    while (ot)
-    {
-        objectList_T *n = ot->next;
-        free(ot);
-        ot = n;
-    }
+    free(detectedNodes);
+    detectedNodes = NULL;
+    detectedCapacity = 0;
     objectPositions = NULL;
     numberOfObjects = 0;
     pthread_mutex_unlock(&objectPositions_lock);
@@ -262,28 +322,48 @@ void checker_shutdown(void)
     }
 }
 
+/* Grow the node storage; caller holds objectPositions_lock */
+static int reserve_nodes(int capacity)
+{
+    if (capacity <= detectedCapacity)
+        return 0;
+    objectList_T *nodes = realloc(detectedNodes, sizeof(objectList_T) * (size_t)capacity);
+    if (!nodes)
+        return -1;
+    detectedNodes = nodes;
+    detectedCapacity = capacity;
+    return 0;
+}
+
+/* Preallocate node storage for up to `capacity` detections */
+int reserveDetectedObjects(int capacity)
+{
+    pthread_mutex_lock(&objectPositions_lock);
+    int rc = reserve_nodes(capacity);
+    /* realloc may have moved the nodes the current list points into */
+    objectPositions = NULL;
+    numberOfObjects = 0;
+    pthread_mutex_unlock(&objectPositions_lock);
+    return rc;
+}
+
 /* Replace detected object list */
 void setDetectedObjects(objectPosition_T *dets, int count)
 {
+    TRACE_BEGIN("setDetectedObjects");
     pthread_mutex_lock(&objectPositions_lock);
+    TRACE_BEGIN("setDetectedObjects locked");
 
-    /* free old list */
-    objectList_T *it = objectPositions;
-    while (it)
-    {
-        objectList_T *n = it->next;
-        free(it);
-        it = n;
-    }
+    /* the old list lives in the same node storage; just rebuild it */
     objectPositions = NULL;
+    if (reserve_nodes(count) != 0)
+        count = detectedCapacity;
 
     /* build new list (doubly linked) */
     objectList_T *tail = NULL;
     for (int i = 0; i < count; ++i)
     {
-        objectList_T *n = malloc(sizeof(objectList_T));
-        if (!n)
-            break;
+        objectList_T *n = &detectedNodes[i];
         n->object = dets[i];
         n->next = NULL;
         n->prev = tail;
@@ -297,7 +377,9 @@ void setDetectedObjects(objectPosition_T *dets, int count)
     for (objectList_T *p = objectPositions; p != NULL; p = p->next)
         numberOfObjects++;
 
+    TRACE_END("setDetectedObjects locked");
     pthread_mutex_unlock(&objectPositions_lock);
+    TRACE_END("setDetectedObjects");
 }
 
 /* Copy up to maxCount detected object centers into out, return copied count */
@@ -312,3 +394,66 @@ int getDetectedObjects(objectPosition_T *out, int maxCount)
     pthread_mutex_unlock(&objectPositions_lock);
     return i;
 }
+
+/* Swap in the table of a new frame; waits for running queries */
+void setCoverageTable(const coverageTable_T *table)
+{
+    pthread_rwlock_wrlock(&coverageTable_lock);
+    coverageTable = table;
+    pthread_rwlock_unlock(&coverageTable_lock);
+}
+
+/* Region queries on the published summed-area table */
+unsigned long long regionCoverage(unsigned int s0, unsigned int z0,
+                                  unsigned int s1, unsigned int z1)
+{
+    unsigned long long sum = 0;
+    pthread_rwlock_rdlock(&coverageTable_lock);
+    if (coverageTable)
+        sum = sat_coverage_sum(coverageTable, s0, z0, s1, z1);
+    pthread_rwlock_unlock(&coverageTable_lock);
+    return sum;
+}
+
+unsigned int regionOccupiedPixels(unsigned int s0, unsigned int z0,
+                                  unsigned int s1, unsigned int z1)
+{
+    unsigned int count = 0;
+    pthread_rwlock_rdlock(&coverageTable_lock);
+    if (coverageTable)
+        count = sat_occupied_count(coverageTable, s0, z0, s1, z1);
+    pthread_rwlock_unlock(&coverageTable_lock);
+    return count;
+}
+
+float regionOccupancy(unsigned int s0, unsigned int z0,
+                      unsigned int s1, unsigned int z1)
+{
+    float occ = 0.0f;
+    pthread_rwlock_rdlock(&coverageTable_lock);
+    if (coverageTable)
+        occ = sat_occupancy(coverageTable, s0, z0, s1, z1);
+    pthread_rwlock_unlock(&coverageTable_lock);
+    return occ;
+}
+
+/* Coarse queries on the pyramid of the published table */
+unsigned int occupancyLevels(void)
+{
+    unsigned int levels = 0;
+    pthread_rwlock_rdlock(&coverageTable_lock);
+    if (coverageTable)
+        levels = coverageTable->levels;
+    pthread_rwlock_unlock(&coverageTable_lock);
+    return levels;
+}
+
+long blockOccupiedPixels(unsigned int level, unsigned int bs, unsigned int bz)
+{
+    long count = -1;
+    pthread_rwlock_rdlock(&coverageTable_lock);
+    if (coverageTable)
+        count = sat_block_count(coverageTable, level, bs, bz);
+    pthread_rwlock_unlock(&coverageTable_lock);
+    return count;
+}
@@ -89,10 +89,22 @@ extern objectList_T *objectPositions;
 /**
  * @brief Replace the detected object list with a new set of centers.
  *
- * Updates `objectPositions` and `numberOfObjects`.
+ * Updates `objectPositions` and `numberOfObjects`. The list nodes are
+ * owned by the checker and reused by the next call.
  */
 void setDetectedObjects(objectPosition_T *dets, int count);
 
+/**
+ * @brief Preallocate storage for up to `capacity` detected objects.
+ *
+ * setDetectedObjects() reuses the same storage for every new list, so
+ * it does not allocate while `count` stays within the reserved
+ * capacity. Clears the current list.
+ *
+ * @return 0 on success, non-zero on error
+ */
+int reserveDetectedObjects(int capacity);
+
 /**
  * @brief Copy up to `maxCount` detected object centers into `out`.
  *
@@ -100,6 +112,61 @@ void setDetectedObjects(objectPosition_T *dets, int count);
  */
 int getDetectedObjects(objectPosition_T *out, int maxCount);
 
+/* Defined in sat.h */
+struct coverageTable_T;
+
+/**
+ * @brief Publish the summed-area table of the latest frame.
+ *
+ * The table must stay valid until it is replaced by the next call;
+ * pass NULL before releasing it. Subsequent region queries read the
+ * published table.
+ */
+void setCoverageTable(const struct coverageTable_T *table);
+
+/**
+ * @brief Total coverage (percent) of the rectangle [s0, s1) x [z0, z1).
+ *
+ * Answered in constant time from the table of the latest frame. The
+ * rectangle is clipped to the image. Returns 0 before the first frame.
+ */
+unsigned long long regionCoverage(unsigned int s0, unsigned int z0,
+                                  unsigned int s1, unsigned int z1);
+
+/**
+ * @brief Number of occupied pixels in the rectangle [s0, s1) x [z0, z1).
+ *
+ * Constant time, see regionCoverage().
+ */
+unsigned int regionOccupiedPixels(unsigned int s0, unsigned int z0,
+                                  unsigned int s1, unsigned int z1);
+
+/**
+ * @brief Mean coverage of the rectangle [s0, s1) x [z0, z1) (0.0–1.0).
+ *
+ * Constant time, see regionCoverage(). Non-zero exactly when
+ * something is inside the rectangle.
+ */
+float regionOccupancy(unsigned int s0, unsigned int z0,
+                      unsigned int s1, unsigned int z1);
+
+/**
+ * @brief Number of levels of the coarse occupancy pyramid (see --pyramid).
+ *
+ * Returns 0 before the first frame or when no pyramid is built.
+ */
+unsigned int occupancyLevels(void);
+
+/**
+ * @brief Occupied pixels in one block of the occupancy pyramid.
+ *
+ * Level L uses blocks of 2^L x 2^L pixels; block (bs, bz) starts at
+ * pixel (bs << L, bz << L). Blocks at the right and bottom border are
+ * clipped to the image. Returns -1 if the level does not exist or the
+ * block lies outside the image.
+ */
+long blockOccupiedPixels(unsigned int level, unsigned int bs, unsigned int bz);
+
 /**
  * @brief Number of objects in the field.
  */
@@ -133,6 +200,34 @@ int init(void);
 /* Utility to add a simulated object (for tests/demo). */
 int addObject(float s, float z, float vx, float vy);
 
+/**
+ * @brief Initial state of a simulated object.
+ */
+typedef struct simObject_T
+{
+  float s;  /**< Horizontal position of the center */
+  float z;  /**< Vertical position of the center */
+  float vx; /**< Velocity in columns per second */
+  float vy; /**< Velocity in rows per second */
+} simObject_T;
+
+/**
+ * @brief Adds a batch of simulated objects.
+ *
+ * Takes the object lock once for the whole batch. Objects come from
+ * an internal pool that grows in slabs and recycles removed objects.
+ *
+ * @param objs Objects to add
+ * @param count Number of entries in `objs`
+ * @return Number of objects added (less than `count` if out of memory)
+ */
+int addObjects(const simObject_T *objs, int count);
+
+/**
+ * @brief Number of simulated objects currently in the simulation.
+ */
+unsigned int simulatedObjectCount(void);
+
 /**
  * @brief Updates the motion state of all objects.
  *
@@ -0,0 +1,247 @@
+#include "edge_analytics.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Run of occupied positions along one side */
+typedef struct
+{
+    int lo, hi;       /* first and last position of the run */
+    int born;         /* ring bias when the blob appeared: +1 outer, -1 inner */
+    uint64_t birth;   /* frame in which the blob appeared */
+    float sumO, sumI; /* outer and inner coverage in the latest frame */
+    float center;     /* coverage-weighted position in the latest frame */
+    int matched;      /* overlapped by a run of the current frame */
+} edgeBlob_T;
+
+struct edgeAnalytics_T
+{
+    unsigned int S, Z;
+    unsigned int segments;
+    int len[EDGE_SIDE_COUNT];    /* positions per side */
+    int off[EDGE_SIDE_COUNT];    /* first outer ring index of each side */
+    float origin[EDGE_SIDE_COUNT]; /* image coordinate of position 0 */
+    float extent[EDGE_SIDE_COUNT]; /* full length of the side in pixels */
+    int half;                    /* outer ring size; inner pixel = outer + half */
+    edgePixel_T *pixels;
+
+    edgeBlob_T *blobs[EDGE_SIDE_COUNT][2]; /* blobs of the previous and current frame */
+    int nblobs[EDGE_SIDE_COUNT][2];
+    int front;                             /* index of the previous frame's blobs */
+
+    edgeEvent_T *events;
+    uint64_t *counts; /* [side][segment][direction] */
+};
+
+static const char *side_names[EDGE_SIDE_COUNT] = {"top", "bottom", "left", "right"};
+
+const char *edge_side_name(edgeSide_T side)
+{
+    return side < EDGE_SIDE_COUNT ? side_names[side] : "?";
+}
+
+static int bias(float outer, float inner)
+{
+    return outer > inner ? 1 : outer < inner ? -1 : 0;
+}
+
+void edge_analytics_free(edgeAnalytics_T *ea)
+{
+    if (!ea)
+        return;
+    for (int e = 0; e < EDGE_SIDE_COUNT; ++e)
+    {
+        free(ea->blobs[e][0]);
+        free(ea->blobs[e][1]);
+    }
+    free(ea->pixels);
+    free(ea->events);
+    free(ea->counts);
+    free(ea);
+}
+
+edgeAnalytics_T *edge_analytics_create(unsigned int cols, unsigned int rows, unsigned int segments)
+{
+    if (cols < 4 || rows < 4 || segments < 1)
+        return NULL;
+    edgeAnalytics_T *ea = calloc(1, sizeof(*ea));
+    if (!ea)
+        return NULL;
+    ea->S = cols;
+    ea->Z = rows;
+    ea->segments = segments;
+
+    /* Top and bottom own the corners; left and right cover the rows between */
+    ea->len[EDGE_SIDE_TOP] = ea->len[EDGE_SIDE_BOTTOM] = (int)cols;
+    ea->len[EDGE_SIDE_LEFT] = ea->len[EDGE_SIDE_RIGHT] = (int)rows - 2;
+    ea->origin[EDGE_SIDE_TOP] = ea->origin[EDGE_SIDE_BOTTOM] = 0.0f;
+    ea->origin[EDGE_SIDE_LEFT] = ea->origin[EDGE_SIDE_RIGHT] = 1.0f;
+    ea->extent[EDGE_SIDE_TOP] = ea->extent[EDGE_SIDE_BOTTOM] = (float)cols;
+    ea->extent[EDGE_SIDE_LEFT] = ea->extent[EDGE_SIDE_RIGHT] = (float)rows;
+    int half = 0;
+    int maxlen = 0;
+    for (int e = 0; e < EDGE_SIDE_COUNT; ++e)
+    {
+        ea->off[e] = half;
+        half += ea->len[e];
+        if (ea->len[e] > maxlen)
+            maxlen = ea->len[e];
+    }
+    ea->half = half;
+
+    ea->pixels = malloc(sizeof(edgePixel_T) * 2 * (size_t)half);
+    /* a side holds at most one blob per two positions; allocate one per position */
+    for (int e = 0; e < EDGE_SIDE_COUNT; ++e)
+    {
+        ea->blobs[e][0] = malloc(sizeof(edgeBlob_T) * (size_t)ea->len[e]);
+        ea->blobs[e][1] = malloc(sizeof(edgeBlob_T) * (size_t)ea->len[e]);
+        if (!ea->blobs[e][0] || !ea->blobs[e][1])
+        {
+            edge_analytics_free(ea);
+            return NULL;
+        }
+    }
+    ea->events = malloc(sizeof(edgeEvent_T) * (size_t)half);
+    ea->counts = calloc((size_t)EDGE_SIDE_COUNT * segments * 2, sizeof(uint64_t));
+    if (!ea->pixels || !ea->events || !ea->counts)
+    {
+        edge_analytics_free(ea);
+        return NULL;
+    }
+
+    /* Outer ring, then the inner ring in the same order */
+    edgePixel_T *o = ea->pixels;
+    edgePixel_T *in = ea->pixels + half;
+    for (unsigned int s = 0; s < cols; ++s)
+    {
+        o[ea->off[EDGE_SIDE_TOP] + s] = (edgePixel_T){s, 0};
+        in[ea->off[EDGE_SIDE_TOP] + s] = (edgePixel_T){s, 1};
+        o[ea->off[EDGE_SIDE_BOTTOM] + s] = (edgePixel_T){s, rows - 1};
+        in[ea->off[EDGE_SIDE_BOTTOM] + s] = (edgePixel_T){s, rows - 2};
+    }
+    for (unsigned int z = 1; z < rows - 1; ++z)
+    {
+        o[ea->off[EDGE_SIDE_LEFT] + z - 1] = (edgePixel_T){0, z};
+        in[ea->off[EDGE_SIDE_LEFT] + z - 1] = (edgePixel_T){1, z};
+        o[ea->off[EDGE_SIDE_RIGHT] + z - 1] = (edgePixel_T){cols - 1, z};
+        in[ea->off[EDGE_SIDE_RIGHT] + z - 1] = (edgePixel_T){cols - 2, z};
+    }
+    return ea;
+}
+
+int edge_analytics_ring_size(const edgeAnalytics_T *ea)
+{
+    return 2 * ea->half;
+}
+
+const edgePixel_T *edge_analytics_pixels(const edgeAnalytics_T *ea)
+{
+    return ea->pixels;
+}
+
+unsigned int edge_analytics_segments(const edgeAnalytics_T *ea)
+{
+    return ea->segments;
+}
+
+uint64_t edge_analytics_count(const edgeAnalytics_T *ea, edgeSide_T side,
+                              unsigned int segment, edgeDirection_T direction)
+{
+    if (side >= EDGE_SIDE_COUNT || segment >= ea->segments)
+        return 0;
+    return ea->counts[((size_t)side * ea->segments + segment) * 2 + direction];
+}
+
+/* Split one side into runs of occupied positions */
+static int find_runs(const coverage_T *outer, const coverage_T *inner, int len, edgeBlob_T *runs)
+{
+    int n = 0;
+    for (int p = 0; p < len; ++p)
+    {
+        if (outer[p] <= 0 && inner[p] <= 0)
+            continue;
+        edgeBlob_T *r = &runs[n++];
+        float sumO = 0.0f, sumI = 0.0f, sumP = 0.0f;
+        r->lo = p;
+        for (; p < len && (outer[p] > 0 || inner[p] > 0); ++p)
+        {
+            float a = (float)(outer[p] + inner[p]);
+            sumO += (float)outer[p];
+            sumI += (float)inner[p];
+            sumP += a * ((float)p + 0.5f);
+        }
+        r->hi = p - 1;
+        r->sumO = sumO;
+        r->sumI = sumI;
+        r->center = sumP / (sumO + sumI);
+        r->matched = 0;
+    }
+    return n;
+}
+
+const edgeEvent_T *edge_analytics_update(edgeAnalytics_T *ea, const coverage_T *ring,
+                                         uint64_t frame, uint64_t timestampNs, int *count)
+{
+    int nev = 0;
+    int back = ea->front ^ 1;
+    for (int e = 0; e < EDGE_SIDE_COUNT; ++e)
+    {
+        edgeBlob_T *prev = ea->blobs[e][ea->front];
+        int np = ea->nblobs[e][ea->front];
+        edgeBlob_T *cur = ea->blobs[e][back];
+        int nc = find_runs(ring + ea->off[e], ring + ea->half + ea->off[e], ea->len[e], cur);
+        ea->nblobs[e][back] = nc;
+
+        /* Both lists are sorted along the side. A run continues every
+           previous blob it overlaps (allowing one pixel of movement) and
+           inherits the origin of the oldest one. */
+        int k = 0;
+        for (int j = 0; j < nc; ++j)
+        {
+            edgeBlob_T *c = &cur[j];
+            while (k < np && prev[k].hi + 1 < c->lo)
+                k++;
+            c->born = 0;
+            c->birth = UINT64_MAX;
+            for (int t = k; t < np && prev[t].lo <= c->hi + 1; ++t)
+            {
+                prev[t].matched = 1;
+                if (prev[t].birth < c->birth)
+                {
+                    c->birth = prev[t].birth;
+                    c->born = prev[t].born;
+                }
+            }
+            if (c->birth == UINT64_MAX)
+            {
+                c->birth = frame;
+                c->born = bias(c->sumO, c->sumI);
+            }
+        }
+
+        /* Blobs without a successor have left the border */
+        for (int t = 0; t < np; ++t)
+        {
+            edgeBlob_T *b = &prev[t];
+            if (b->matched)
+                continue;
+            int last = bias(b->sumO, b->sumI);
+            edgeDirection_T dir;
+            if (b->born > 0 && last < 0)
+                dir = EDGE_DIR_IN;
+            else if (b->born < 0 && last > 0)
+                dir = EDGE_DIR_OUT;
+            else
+                continue;
+
+            float pos = ea->origin[e] + b->center;
+            unsigned int seg = (unsigned int)(pos * (float)ea->segments / ea->extent[e]);
+            if (seg >= ea->segments)
+                seg = ea->segments - 1;
+            ea->counts[((size_t)e * ea->segments + seg) * 2 + dir]++;
+            ea->events[nev++] = (edgeEvent_T){frame, timestampNs, (edgeSide_T)e, seg, dir, pos};
+        }
+    }
+    ea->front = back;
+    *count = nev;
+    return ea->events;
+}
@@ -0,0 +1,128 @@
+#ifndef EDGE_ANALYTICS_H
+#define EDGE_ANALYTICS_H
+
+#include <stdint.h>
+
+#include "checker.h"
+
+/**
+ * @brief Side of the image border.
+ */
+typedef enum edgeSide_T
+{
+  EDGE_SIDE_TOP,
+  EDGE_SIDE_BOTTOM,
+  EDGE_SIDE_LEFT,
+  EDGE_SIDE_RIGHT,
+  EDGE_SIDE_COUNT
+} edgeSide_T;
+
+/**
+ * @brief Direction of a border crossing.
+ */
+typedef enum edgeDirection_T
+{
+  EDGE_DIR_IN,  /**< Object entered the image */
+  EDGE_DIR_OUT  /**< Object left the image */
+} edgeDirection_T;
+
+/**
+ * @brief Pixel of the scanned border ring.
+ */
+typedef struct edgePixel_T
+{
+  unsigned int s; /**< Column index */
+  unsigned int z; /**< Row index */
+} edgePixel_T;
+
+/**
+ * @brief Completed crossing of the image border.
+ */
+typedef struct edgeEvent_T
+{
+  uint64_t frame;            /**< Frame in which the crossing completed */
+  uint64_t timestampNs;      /**< CLOCK_REALTIME of that frame in nanoseconds */
+  edgeSide_T side;           /**< Side that was crossed */
+  unsigned int segment;      /**< Segment of that side */
+  edgeDirection_T direction; /**< Entry or exit */
+  float pos;                 /**< Column (top/bottom) or row (left/right) of the crossing */
+} edgeEvent_T;
+
+/**
+ * @brief Line-crossing analytics computed from the image border only.
+ *
+ * Scans a ring two pixels deep along the border: the outer ring is the
+ * regular edge scan, the inner ring lies one pixel further in. Runs of
+ * occupied positions along each side form border blobs that are tracked
+ * from frame to frame by overlap. When a blob disappears, comparing its
+ * outer and inner coverage at birth and at its last sighting gives the
+ * direction: born on the outer ring and last seen on the inner ring is
+ * an entry, the reverse is an exit, anything else (grazing or bouncing
+ * objects) is not counted. Blobs that merge along the border continue
+ * as one, so objects crossing side by side count once.
+ *
+ * Every side is split into equal segments with their own in/out
+ * counters. The cost per frame is proportional to the perimeter.
+ */
+typedef struct edgeAnalytics_T edgeAnalytics_T;
+
+/**
+ * @brief Creates the analytics state for an S x Z image.
+ *
+ * @param cols Number of columns (at least 4)
+ * @param rows Number of rows (at least 4)
+ * @param segments Segments per side (at least 1)
+ * @return New state, or NULL on error
+ */
+edgeAnalytics_T *edge_analytics_create(unsigned int cols, unsigned int rows, unsigned int segments);
+
+/**
+ * @brief Frees the analytics state.
+ */
+void edge_analytics_free(edgeAnalytics_T *ea);
+
+/**
+ * @brief Number of pixels in the scanned ring.
+ *
+ * The first half is the outer ring, the second half the inner ring;
+ * pixel i + ring/2 lies directly inside pixel i.
+ */
+int edge_analytics_ring_size(const edgeAnalytics_T *ea);
+
+/**
+ * @brief Coordinates of the ring pixels, in scan order.
+ */
+const edgePixel_T *edge_analytics_pixels(const edgeAnalytics_T *ea);
+
+/**
+ * @brief Processes the coverage of one frame's ring scan.
+ *
+ * Does not allocate.
+ *
+ * @param ea Analytics state
+ * @param ring Coverage per ring pixel, in edge_analytics_pixels() order
+ * @param frame Frame number
+ * @param timestampNs Timestamp of the frame
+ * @param count Receives the number of crossings completed in this frame
+ * @return Crossings of this frame, valid until the next update
+ */
+const edgeEvent_T *edge_analytics_update(edgeAnalytics_T *ea, const coverage_T *ring,
+                                         uint64_t frame, uint64_t timestampNs, int *count);
+
+/**
+ * @brief Number of segments per side.
+ */
+unsigned int edge_analytics_segments(const edgeAnalytics_T *ea);
+
+/**
+ * @brief Crossings counted so far on one segment.
+ */
+uint64_t edge_analytics_count(const edgeAnalytics_T *ea, edgeSide_T side,
+                              unsigned int segment, edgeDirection_T direction);
+
+/**
+ * @brief Lower-case name of a side ("top", "bottom", "left", "right").
+ */
+const char *edge_side_name(edgeSide_T side);
+
+#endif /* EDGE_ANALYTICS_H */
@@ -0,0 +1,138 @@
+#include "sat.h"
+#include <stdlib.h>
+#include <string.h>
+
+int sat_init(coverageTable_T *t, unsigned int cols, unsigned int rows, unsigned int levels)
+{
+    memset(t, 0, sizeof(*t));
+    if (levels > SAT_MAX_LEVELS)
+        levels = SAT_MAX_LEVELS;
+    size_t n = ((size_t)cols + 1) * ((size_t)rows + 1);
+    t->S = cols;
+    t->Z = rows;
+    t->sum = calloc(n, sizeof(uint64_t));
+    t->count = calloc(n, sizeof(uint32_t));
+    if (!t->sum || !t->count)
+    {
+        sat_free(t);
+        return -1;
+    }
+    for (unsigned int l = 0; l < levels; ++l)
+    {
+        coverageLevel_T *lv = &t->level[l];
+        unsigned int shift = l + 1;
+        lv->w = (cols + (1u << shift) - 1) >> shift;
+        lv->h = (rows + (1u << shift) - 1) >> shift;
+        lv->cells = calloc((size_t)lv->w * lv->h, sizeof(uint32_t));
+        if (!lv->cells)
+        {
+            sat_free(t);
+            return -1;
+        }
+        t->levels = l + 1;
+    }
+    return 0;
+}
+
+void sat_free(coverageTable_T *t)
+{
+    free(t->sum);
+    free(t->count);
+    for (unsigned int l = 0; l < t->levels; ++l)
+        free(t->level[l].cells);
+    memset(t, 0, sizeof(*t));
+}
+
+/* Every pyramid cell is one rectangle query on the count table */
+static void build_pyramid(coverageTable_T *t)
+{
+    for (unsigned int l = 0; l < t->levels; ++l)
+    {
+        coverageLevel_T *lv = &t->level[l];
+        unsigned int shift = l + 1;
+        for (unsigned int bz = 0; bz < lv->h; ++bz)
+            for (unsigned int bs = 0; bs < lv->w; ++bs)
+                lv->cells[bz * lv->w + bs] =
+                    sat_occupied_count(t, bs << shift, bz << shift,
+                                       (bs + 1) << shift, (bz + 1) << shift);
+    }
+}
+
+void sat_build_tiled(coverageTable_T *t, const tileLayout_T *layout, const coverage_T *tiles)
+{
+    size_t W = (size_t)t->S + 1;
+    for (unsigned int z = 0; z < t->Z; ++z)
+    {
+        /* running row total plus the finished row above */
+        uint64_t rowSum = 0;
+        uint32_t rowCount = 0;
+        uint64_t *sumAbove = t->sum + (size_t)z * W;
+        uint32_t *countAbove = t->count + (size_t)z * W;
+        uint64_t *sum = sumAbove + W;
+        uint32_t *count = countAbove + W;
+        /* a row is contiguous within each tile it crosses */
+        for (unsigned int s0 = 0; s0 < t->S; s0 += TILE_DIM)
+        {
+            const coverage_T *g = tiles + tile_index(layout, s0, z);
+            unsigned int s1 = s0 + TILE_DIM < t->S ? s0 + TILE_DIM : t->S;
+            for (unsigned int s = s0; s < s1; ++s)
+            {
+                coverage_T c = g[s - s0];
+                rowSum += (uint64_t)c;
+                rowCount += c > 0;
+                sum[s + 1] = sumAbove[s + 1] + rowSum;
+                count[s + 1] = countAbove[s + 1] + rowCount;
+            }
+        }
+    }
+    build_pyramid(t);
+}
+
+/* Clip [s0, s1) x [z0, z1) to the image; returns 0 if it is empty */
+static int clip(const coverageTable_T *t, unsigned int *s0, unsigned int *z0,
+                unsigned int *s1, unsigned int *z1)
+{
+    if (*s1 > t->S)
+        *s1 = t->S;
+    if (*z1 > t->Z)
+        *z1 = t->Z;
+    return *s0 < *s1 && *z0 < *z1;
+}
+
+uint64_t sat_coverage_sum(const coverageTable_T *t, unsigned int s0, unsigned int z0,
+                          unsigned int s1, unsigned int z1)
+{
+    if (!clip(t, &s0, &z0, &s1, &z1))
+        return 0;
+    size_t W = (size_t)t->S + 1;
+    return t->sum[z1 * W + s1] - t->sum[z0 * W + s1] - t->sum[z1 * W + s0] + t->sum[z0 * W + s0];
+}
+
+uint32_t sat_occupied_count(const coverageTable_T *t, unsigned int s0, unsigned int z0,
+                            unsigned int s1, unsigned int z1)
+{
+    if (!clip(t, &s0, &z0, &s1, &z1))
+        return 0;
+    size_t W = (size_t)t->S + 1;
+    return t->count[z1 * W + s1] - t->count[z0 * W + s1] - t->count[z1 * W + s0] + t->count[z0 * W + s0];
+}
+
+float sat_occupancy(const coverageTable_T *t, unsigned int s0, unsigned int z0,
+                    unsigned int s1, unsigned int z1)
+{
+    if (!clip(t, &s0, &z0, &s1, &z1))
+        return 0.0f;
+    uint64_t area = (uint64_t)(s1 - s0) * (z1 - z0);
+    return (float)sat_coverage_sum(t, s0, z0, s1, z1) / (100.0f * (float)area);
+}
+
+long sat_block_count(const coverageTable_T *t, unsigned int level,
+                     unsigned int bs, unsigned int bz)
+{
+    if (level < 1 || level > t->levels)
+        return -1;
+    const coverageLevel_T *lv = &t->level[level - 1];
+    if (bs >= lv->w || bz >= lv->h)
+        return -1;
+    return (long)lv->cells[bz * lv->w + bs];
+}
@@ -0,0 +1,104 @@
+#ifndef SAT_H
+#define SAT_H
+
+#include <stdint.h>
+
+#include "checker.h"
+#include "tile.h"
+
+/**
+ * @brief Maximum number of pyramid levels above full resolution.
+ */
+#define SAT_MAX_LEVELS 8
+
+/**
+ * @brief Coarse occupancy map of one pyramid level.
+ *
+ * With blocks of B x B pixels, cell (bs, bz) holds the number of
+ * occupied pixels in the block starting at pixel (bs * B, bz * B).
+ */
+typedef struct coverageLevel_T
+{
+  unsigned int w;   /**< Number of block columns */
+  unsigned int h;   /**< Number of block rows */
+  uint32_t *cells;  /**< Occupied pixels per block, row-major */
+} coverageLevel_T;
+
+/**
+ * @brief Summed-area table (integral image) of a coverage grid.
+ *
+ * Entry (s, z) of each table holds the total over all pixels above and
+ * to the left of pixel (s, z), so the total over any rectangle takes
+ * four lookups. The tables have (S + 1) x (Z + 1) entries; row and
+ * column 0 are zero.
+ */
+typedef struct coverageTable_T
+{
+  unsigned int S;     /**< Number of columns of the image */
+  unsigned int Z;     /**< Number of rows of the image */
+  uint64_t *sum;      /**< Prefix sums of the coverage (percent) */
+  uint32_t *count;    /**< Prefix counts of occupied pixels */
+  unsigned int levels; /**< Number of pyramid levels in `level` */
+  coverageLevel_T level[SAT_MAX_LEVELS]; /**< level[i] uses blocks of 2^(i+1) x 2^(i+1) pixels */
+} coverageTable_T;
+
+/**
+ * @brief Allocates the tables for an image of `cols` x `rows` pixels.
+ *
+ * @param levels Number of pyramid levels to maintain (0 to SAT_MAX_LEVELS)
+ * @return 0 on success, non-zero on error
+ */
+int sat_init(coverageTable_T *t, unsigned int cols, unsigned int rows, unsigned int levels);
+
+/**
+ * @brief Releases the tables.
+ */
+void sat_free(coverageTable_T *t);
+
+/**
+ * @brief Rebuilds the tables and pyramid from a tiled coverage buffer.
+ *
+ * @param layout Tile layout of an S x Z frame
+ * @param tiles Coverage values, index tile_index(layout, s, z)
+ */
+void sat_build_tiled(coverageTable_T *t, const tileLayout_T *layout, const coverage_T *tiles);
+
+/**
+ * @brief Sum of the coverage (percent) over [s0, s1) x [z0, z1).
+ *
+ * The rectangle is clipped to the image. Constant time.
+ */
+uint64_t sat_coverage_sum(const coverageTable_T *t, unsigned int s0, unsigned int z0,
+                          unsigned int s1, unsigned int z1);
+
+/**
+ * @brief Number of occupied pixels in [s0, s1) x [z0, z1).
+ *
+ * The rectangle is clipped to the image. Constant time.
+ */
+uint32_t sat_occupied_count(const coverageTable_T *t, unsigned int s0, unsigned int z0,
+                            unsigned int s1, unsigned int z1);
+
+/**
+ * @brief Mean coverage of [s0, s1) x [z0, z1) in the range 0 to 1.
+ *
+ * The rectangle is clipped to the image; an empty rectangle yields 0.
+ * Constant time.
+ */
+float sat_occupancy(const coverageTable_T *t, unsigned int s0, unsigned int z0,
+                    unsigned int s1, unsigned int z1);
+
+/**
+ * @brief Occupied pixels of one block of a pyramid level.
+ *
+ * @param level Pyramid level, 1 for 2x2 blocks up to `levels` for
+ *              2^levels x 2^levels blocks
+ * @param bs Block column
+ * @param bz Block row
+ * @return Number of occupied pixels, or -1 if the level was not built
+ *         or the block lies outside the image
+ */
+long sat_block_count(const coverageTable_T *t, unsigned int level,
+                     unsigned int bs, unsigned int bz);
+
+#endif /* SAT_H */
@@ -0,0 +1,465 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "scenario.h"
+#include "checker.h"
+#include "trace.h"
+#ifdef SURV_ALLOC_TEST
+#include "alloc_count.h"
+#endif
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SCENARIO_MAX_SPAWNS 16
+#define SCENARIO_MAX_BURSTS 64
+/* Objects per addObjects() call; bounds how long check() readers wait */
+#define SCENARIO_BATCH 8192
+
+typedef enum
+{
+    EDGE_LEFT,
+    EDGE_RIGHT,
+    EDGE_TOP,
+    EDGE_BOTTOM,
+    EDGE_ANY
+} scenarioEdge_T;
+
+typedef enum
+{
+    DIST_CONST,
+    DIST_UNIFORM,
+    DIST_NORMAL
+} scenarioDistKind_T;
+
+typedef struct
+{
+    scenarioDistKind_T kind;
+    float a; /* constant, lower bound or mean */
+    float b; /* upper bound or standard deviation */
+} scenarioDist_T;
+
+typedef struct
+{
+    scenarioEdge_T edge;
+    float rate;   /* objects per second */
+    scenarioDist_T speed;
+    scenarioDist_T drift;
+    double carry; /* fractional objects owed from previous ticks */
+} scenarioSpawn_T;
+
+typedef struct
+{
+    scenarioEdge_T edge;
+    double at; /* seconds after start */
+    int count;
+    scenarioDist_T speed;
+    scenarioDist_T drift;
+    int done;
+} scenarioBurst_T;
+
+struct scenario_T
+{
+    uint64_t rng;
+    unsigned int tick_ms;
+    double duration;
+    unsigned int population;
+    scenarioSpawn_T spawns[SCENARIO_MAX_SPAWNS];
+    int nspawns;
+    scenarioBurst_T bursts[SCENARIO_MAX_BURSTS];
+    int nbursts;
+
+    simObject_T *batch; /* objects of the current tick */
+    int nbatch;
+    int batch_cap;
+
+    pthread_t thread;
+    atomic_int running;
+    _Atomic uint64_t spawned;
+};
+
+static const scenarioDist_T default_speed = {DIST_UNIFORM, 0.5f, 1.5f};
+static const scenarioDist_T default_drift = {DIST_CONST, 0.0f, 0.0f};
+
+/* xorshift64* generator */
+static uint64_t rng_next(scenario_T *sc)
+{
+    sc->rng ^= sc->rng >> 12;
+    sc->rng ^= sc->rng << 25;
+    sc->rng ^= sc->rng >> 27;
+    return sc->rng * 0x2545F4914F6CDD1DULL;
+}
+
+/* Uniform in [0, 1) */
+static float rng_unit(scenario_T *sc)
+{
+    return (float)(rng_next(sc) >> 40) / (float)(1ULL << 24);
+}
+
+static float dist_sample(scenario_T *sc, const scenarioDist_T *d)
+{
+    switch (d->kind)
+    {
+    case DIST_UNIFORM:
+        return d->a + (d->b - d->a) * rng_unit(sc);
+    case DIST_NORMAL:
+    {
+        /* Box-Muller */
+        float u1 = rng_unit(sc);
+        float u2 = rng_unit(sc);
+        if (u1 < 1e-7f)
+            u1 = 1e-7f;
+        return d->a + d->b * sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+    }
+    default:
+        return d->a;
+    }
+}
+
+/* ---- parsing ---- */
+
+static int parse_edge(const char *w, scenarioEdge_T *edge)
+{
+    static const char *names[] = {"left", "right", "top", "bottom", "any"};
+    for (int i = 0; i < 5; ++i)
+    {
+        if (strcmp(w, names[i]) == 0)
+        {
+            *edge = (scenarioEdge_T)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int parse_dist(const char *v, scenarioDist_T *d)
+{
+    char *end;
+    if (strncmp(v, "uniform:", 8) == 0 || strncmp(v, "normal:", 7) == 0)
+    {
+        d->kind = v[0] == 'u' ? DIST_UNIFORM : DIST_NORMAL;
+        v = strchr(v, ':') + 1;
+        d->a = strtof(v, &end);
+        if (*end != ':')
+            return -1;
+        d->b = strtof(end + 1, &end);
+        return *end == '\0' ? 0 : -1;
+    }
+    d->kind = DIST_CONST;
+    d->a = strtof(v, &end);
+    d->b = 0.0f;
+    return *end == '\0' && end != v ? 0 : -1;
+}
+
+static int parse_number(const char *v, double *out)
+{
+    char *end;
+    *out = strtod(v, &end);
+    return *end == '\0' && end != v ? 0 : -1;
+}
+
+/* Parse the key=value options of a spawn or burst line */
+static int parse_options(char *save, float *rate, double *at, int *count,
+                         scenarioDist_T *speed, scenarioDist_T *drift)
+{
+    char *w;
+    while ((w = strtok_r(NULL, " \t", &save)) != NULL)
+    {
+        char *eq = strchr(w, '=');
+        if (!eq)
+            return -1;
+        *eq = '\0';
+        const char *v = eq + 1;
+        double num;
+        if (strcmp(w, "speed") == 0)
+        {
+            if (parse_dist(v, speed) != 0)
+                return -1;
+        }
+        else if (strcmp(w, "drift") == 0)
+        {
+            if (parse_dist(v, drift) != 0)
+                return -1;
+        }
+        else if (strcmp(w, "rate") == 0 && rate && parse_number(v, &num) == 0 && num >= 0)
+            *rate = (float)num;
+        else if (strcmp(w, "at") == 0 && at && parse_number(v, &num) == 0 && num >= 0)
+            *at = num;
+        else if (strcmp(w, "count") == 0 && count && parse_number(v, &num) == 0 &&
+                 num >= 1 && num <= INT_MAX && num == floor(num))
+            *count = (int)num;
+        else
+            return -1;
+    }
+    return 0;
+}
+
+static int parse_line(scenario_T *sc, char *line)
+{
+    char *save;
+    char *cmd = strtok_r(line, " \t", &save);
+    if (!cmd)
+        return 0; /* blank line */
+    double num;
+
+    if (strcmp(cmd, "seed") == 0 || strcmp(cmd, "tick") == 0 ||
+        strcmp(cmd, "duration") == 0 || strcmp(cmd, "population") == 0)
+    {
+        char *v = strtok_r(NULL, " \t", &save);
+        if (!v || parse_number(v, &num) != 0 || num < 0 || strtok_r(NULL, " \t", &save))
+            return -1;
+        if (cmd[0] == 's')
+            sc->rng = (uint64_t)num ? (uint64_t)num : 1;
+        else if (cmd[0] == 't')
+            sc->tick_ms = num >= 1 ? (unsigned int)num : 1;
+        else if (cmd[0] == 'd')
+            sc->duration = num;
+        else
+            sc->population = (unsigned int)num;
+        return 0;
+    }
+
+    char *e = strtok_r(NULL, " \t", &save);
+    scenarioEdge_T edge;
+    if (!e || parse_edge(e, &edge) != 0)
+        return -1;
+
+    if (strcmp(cmd, "spawn") == 0)
+    {
+        if (sc->nspawns == SCENARIO_MAX_SPAWNS)
+            return -1;
+        scenarioSpawn_T *sp = &sc->spawns[sc->nspawns];
+        memset(sp, 0, sizeof(*sp));
+        sp->edge = edge;
+        sp->speed = default_speed;
+        sp->drift = default_drift;
+        if (parse_options(save, &sp->rate, NULL, NULL, &sp->speed, &sp->drift) != 0)
+            return -1;
+        sc->nspawns++;
+        return 0;
+    }
+    if (strcmp(cmd, "burst") == 0)
+    {
+        if (sc->nbursts == SCENARIO_MAX_BURSTS)
+            return -1;
+        scenarioBurst_T *b = &sc->bursts[sc->nbursts];
+        memset(b, 0, sizeof(*b));
+        b->edge = edge;
+        b->speed = default_speed;
+        b->drift = default_drift;
+        if (parse_options(save, NULL, &b->at, &b->count, &b->speed, &b->drift) != 0)
+            return -1;
+        sc->nbursts++;
+        return 0;
+    }
+    return -1;
+}
+
+scenario_T *scenario_load(const char *path, char *err, size_t errlen)
+{
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        snprintf(err, errlen, "cannot open %s", path);
+        return NULL;
+    }
+    scenario_T *sc = calloc(1, sizeof(*sc));
+    if (!sc)
+    {
+        fclose(f);
+        snprintf(err, errlen, "out of memory");
+        return NULL;
+    }
+    sc->rng = 1;
+    sc->tick_ms = 100;
+
+    char line[512];
+    int lineno = 0;
+    while (fgets(line, sizeof(line), f))
+    {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash)
+            *hash = '\0';
+        line[strcspn(line, "\r\n")] = '\0';
+        if (parse_line(sc, line) != 0)
+        {
+            snprintf(err, errlen, "%s:%d: invalid line", path, lineno);
+            fclose(f);
+            free(sc);
+            return NULL;
+        }
+    }
+    fclose(f);
+    return sc;
+}
+
+/* ---- injection ---- */
+
+/* Append one object entering through `edge` to the batch */
+static int emit(scenario_T *sc, scenarioEdge_T edge,
+                const scenarioDist_T *speed, const scenarioDist_T *drift)
+{
+    if (sc->nbatch == sc->batch_cap)
+    {
+        int cap = sc->batch_cap ? 2 * sc->batch_cap : 1024;
+        simObject_T *b = realloc(sc->batch, sizeof(simObject_T) * (size_t)cap);
+        if (!b)
+            return -1;
+        sc->batch = b;
+        sc->batch_cap = cap;
+    }
+    if (edge == EDGE_ANY)
+        edge = (scenarioEdge_T)(rng_next(sc) % 4);
+
+    float v = dist_sample(sc, speed);
+    float d = dist_sample(sc, drift);
+    simObject_T *o = &sc->batch[sc->nbatch++];
+    switch (edge)
+    {
+    case EDGE_LEFT:
+        *o = (simObject_T){-0.5f, rng_unit(sc) * (float)Z, v, d};
+        break;
+    case EDGE_RIGHT:
+        *o = (simObject_T){(float)S + 0.5f, rng_unit(sc) * (float)Z, -v, d};
+        break;
+    case EDGE_TOP:
+        *o = (simObject_T){rng_unit(sc) * (float)S, -0.5f, d, v};
+        break;
+    default:
+        *o = (simObject_T){rng_unit(sc) * (float)S, (float)Z + 0.5f, d, -v};
+        break;
+    }
+    return 0;
+}
+
+/* Pick a spawn rule with probability proportional to its rate */
+static const scenarioSpawn_T *pick_spawn(scenario_T *sc)
+{
+    float total = 0.0f;
+    for (int i = 0; i < sc->nspawns; ++i)
+        total += sc->spawns[i].rate;
+    if (total <= 0.0f)
+        return NULL;
+    float r = rng_unit(sc) * total;
+    for (int i = 0; i < sc->nspawns; ++i)
+    {
+        r -= sc->spawns[i].rate;
+        if (r < 0.0f)
+            return &sc->spawns[i];
+    }
+    return &sc->spawns[sc->nspawns - 1];
+}
+
+/* Collect the objects due in one tick of `dt` seconds ending at `t` */
+static void step(scenario_T *sc, double t, double dt)
+{
+    sc->nbatch = 0;
+    for (int i = 0; i < sc->nspawns; ++i)
+    {
+        scenarioSpawn_T *sp = &sc->spawns[i];
+        sp->carry += sp->rate * dt;
+        while (sp->carry >= 1.0)
+        {
+            sp->carry -= 1.0;
+            if (emit(sc, sp->edge, &sp->speed, &sp->drift) != 0)
+                return;
+        }
+    }
+    for (int i = 0; i < sc->nbursts; ++i)
+    {
+        scenarioBurst_T *b = &sc->bursts[i];
+        if (b->done || t < b->at)
+            continue;
+        b->done = 1;
+        for (int k = 0; k < b->count; ++k)
+            if (emit(sc, b->edge, &b->speed, &b->drift) != 0)
+                return;
+    }
+    if (sc->population > 0)
+    {
+        unsigned int alive = simulatedObjectCount() + (unsigned int)sc->nbatch;
+        for (; alive < sc->population; ++alive)
+        {
+            const scenarioSpawn_T *sp = pick_spawn(sc);
+            int rc = sp ? emit(sc, sp->edge, &sp->speed, &sp->drift)
+                        : emit(sc, EDGE_ANY, &default_speed, &default_drift);
+            if (rc != 0)
+                return;
+        }
+    }
+}
+
+static double mono_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void *scenario_loop(void *arg)
+{
+    scenario_T *sc = (scenario_T *)arg;
+    trace_thread_name("scenario");
+#ifdef SURV_ALLOC_TEST
+    alloc_count_exclude_thread(); /* workload source, not part of the frame loop */
+#endif
+    double start = mono_s();
+    double last = start;
+    while (atomic_load(&sc->running))
+    {
+        double now = mono_s();
+        double t = now - start;
+        if (sc->duration > 0.0 && t > sc->duration)
+            break;
+
+        TRACE_BEGIN("scenario tick");
+        step(sc, t, now - last);
+        for (int off = 0; off < sc->nbatch; off += SCENARIO_BATCH)
+        {
+            int n = sc->nbatch - off < SCENARIO_BATCH ? sc->nbatch - off : SCENARIO_BATCH;
+            int added = addObjects(sc->batch + off, n);
+            atomic_fetch_add(&sc->spawned, (uint64_t)added);
+            if (added < n)
+                break;
+        }
+        TRACE_END("scenario tick");
+        last = now;
+
+        struct timespec req = {.tv_sec = sc->tick_ms / 1000, .tv_nsec = (long)(sc->tick_ms % 1000) * 1000000L};
+        nanosleep(&req, NULL);
+    }
+    return NULL;
+}
+
+int scenario_start(scenario_T *sc)
+{
+    atomic_store(&sc->running, 1);
+    if (pthread_create(&sc->thread, NULL, scenario_loop, sc) != 0)
+    {
+        atomic_store(&sc->running, 0);
+        return -1;
+    }
+    return 0;
+}
+
+uint64_t scenario_spawned(const scenario_T *sc)
+{
+    return atomic_load(&sc->spawned);
+}
+
+void scenario_free(scenario_T *sc)
+{
+    if (!sc)
+        return;
+    if (atomic_exchange(&sc->running, 0))
+        pthread_join(sc->thread, NULL);
+    free(sc->batch);
+    free(sc);
+}
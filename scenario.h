@@ -0,0 +1,58 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Scripted workload that injects simulated objects.
+ *
+ * A scenario file is read line by line; `#` starts a comment. Edges are
+ * `left`, `right`, `top`, `bottom` or `any`. Distributions are written
+ * as a constant (`1.5`), `uniform:LO:HI` or `normal:MEAN:SD`.
+ *
+ * - `seed N` — seed of the random generator (default 1)
+ * - `tick MS` — interval between injection steps (default 100)
+ * - `duration SEC` — stop injecting after SEC seconds (default 0: never)
+ * - `population N` — top the simulation up to N live objects every tick
+ * - `spawn EDGE rate=R [speed=D] [drift=D]` — R objects per second
+ *   entering through EDGE, moving inwards at `speed` (columns or rows
+ *   per second) with a sideways velocity `drift`
+ * - `burst EDGE at=SEC count=N [speed=D] [drift=D]` — N (>= 1) objects at once,
+ *   SEC seconds after start
+ *
+ * Objects of one tick are added with a single addObjects() call per
+ * batch instead of one locked addObject() per object.
+ */
+typedef struct scenario_T scenario_T;
+
+/**
+ * @brief Parses a scenario file.
+ *
+ * @param path Scenario file
+ * @param err Receives a message on failure
+ * @param errlen Size of `err`
+ * @return New scenario, or NULL on error
+ */
+scenario_T *scenario_load(const char *path, char *err, size_t errlen);
+
+/**
+ * @brief Starts injecting objects from a background thread.
+ *
+ * Requires an initialized checker framework (see init()).
+ *
+ * @return 0 on success, non-zero on error
+ */
+int scenario_start(scenario_T *sc);
+
+/**
+ * @brief Number of objects injected so far.
+ */
+uint64_t scenario_spawned(const scenario_T *sc);
+
+/**
+ * @brief Stops the injection thread and frees the scenario.
+ */
+void scenario_free(scenario_T *sc);
+
+#endif /* SCENARIO_H */
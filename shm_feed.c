@@ -0,0 +1,174 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "shm_feed.h"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Producer state */
+static shmFeedHeader_T *feed = NULL;
+static char feed_name[256];
+
+/* Create (or replace) the segment and initialize its header */
+int shm_feed_open(const char *name, unsigned int cols, unsigned int rows)
+{
+    if (feed || strlen(name) >= sizeof(feed_name))
+        return -1;
+
+    shm_unlink(name); /* drop a stale segment of a previous run */
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0)
+        return -1;
+    if (ftruncate(fd, (off_t)sizeof(shmFeedHeader_T)) != 0)
+    {
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+    void *p = mmap(NULL, sizeof(shmFeedHeader_T), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+    {
+        shm_unlink(name);
+        return -1;
+    }
+
+    /* Fresh segments are zero-filled, so all slot counters start at 0 */
+    feed = p;
+    feed->version = SHM_FEED_VERSION;
+    feed->slotCount = SHM_FEED_SLOTS;
+    feed->maxDetections = SHM_FEED_MAX_DETECTIONS;
+    feed->S = cols;
+    feed->Z = rows;
+    atomic_store_explicit(&feed->head, 0, memory_order_relaxed);
+    /* readers check the magic last, so publish it after everything else */
+    atomic_store_explicit(&feed->magic, SHM_FEED_MAGIC, memory_order_release);
+    strcpy(feed_name, name);
+    return 0;
+}
+
+/* Write one frame into the next slot (seqlock writer side) */
+void shm_feed_publish(uint64_t frame, uint64_t timestampNs,
+                      const objectPosition_T *dets, int count)
+{
+    if (!feed)
+        return;
+
+    uint64_t n = atomic_load_explicit(&feed->head, memory_order_relaxed);
+    shmFeedSlot_T *slot = &feed->slots[n % SHM_FEED_SLOTS];
+    uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+
+    /* mark the slot as being written before touching its payload */
+    atomic_store_explicit(&slot->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    uint32_t c = count > 0 ? (uint32_t)count : 0;
+    slot->truncated = c > SHM_FEED_MAX_DETECTIONS;
+    if (c > SHM_FEED_MAX_DETECTIONS)
+        c = SHM_FEED_MAX_DETECTIONS;
+    slot->frame = frame;
+    slot->timestampNs = timestampNs;
+    slot->count = c;
+    memcpy(slot->detections, dets, sizeof(objectPosition_T) * c);
+
+    atomic_store_explicit(&slot->seq, seq + 2, memory_order_release);
+    atomic_store_explicit(&feed->head, n + 1, memory_order_release);
+}
+
+/* Unmap and remove the segment */
+void shm_feed_close(void)
+{
+    if (!feed)
+        return;
+    munmap(feed, sizeof(shmFeedHeader_T));
+    feed = NULL;
+    shm_unlink(feed_name);
+}
+
+/* Map an existing segment read-only and start at the live head */
+int shm_feed_reader_open(shmFeedReader_T *r, const char *name)
+{
+    memset(r, 0, sizeof(*r));
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(shmFeedHeader_T))
+    {
+        close(fd);
+        return -1;
+    }
+    void *p = mmap(NULL, sizeof(shmFeedHeader_T), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return -1;
+
+    const shmFeedHeader_T *hdr = p;
+    if (atomic_load_explicit(&hdr->magic, memory_order_acquire) != SHM_FEED_MAGIC ||
+        hdr->version != SHM_FEED_VERSION || hdr->slotCount != SHM_FEED_SLOTS ||
+        hdr->maxDetections != SHM_FEED_MAX_DETECTIONS)
+    {
+        munmap(p, sizeof(shmFeedHeader_T));
+        return -1;
+    }
+    r->hdr = hdr;
+    r->size = sizeof(shmFeedHeader_T);
+    uint64_t head = atomic_load_explicit(&hdr->head, memory_order_acquire);
+    r->next = head > 0 ? head - 1 : 0;
+    return 0;
+}
+
+/* Locate the next readable slot, skipping frames that were overwritten */
+const shmFeedSlot_T *shm_feed_begin_read(shmFeedReader_T *r, uint64_t *seq)
+{
+    for (;;)
+    {
+        uint64_t head = atomic_load_explicit(&r->hdr->head, memory_order_acquire);
+        if (r->next >= head)
+            return NULL;
+        if (head - r->next > SHM_FEED_SLOTS)
+        {
+            /* lapped by the producer: jump to the oldest frame still present */
+            r->lost += head - SHM_FEED_SLOTS - r->next;
+            r->next = head - SHM_FEED_SLOTS;
+        }
+
+        const shmFeedSlot_T *slot = &r->hdr->slots[r->next % SHM_FEED_SLOTS];
+        uint64_t expected = 2 * (r->next / SHM_FEED_SLOTS + 1);
+        uint64_t s = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (s == expected)
+        {
+            *seq = s;
+            return slot;
+        }
+        /* being rewritten or already overwritten by a newer frame */
+        r->lost++;
+        r->next++;
+    }
+}
+
+/* Validate that the slot did not change while it was read */
+int shm_feed_end_read(shmFeedReader_T *r, const shmFeedSlot_T *slot, uint64_t seq)
+{
+    atomic_thread_fence(memory_order_acquire);
+    uint64_t s = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    r->next++;
+    if (s != seq)
+    {
+        r->lost++;
+        return 0;
+    }
+    return 1;
+}
+
+/* Unmap the segment of a reader */
+void shm_feed_reader_close(shmFeedReader_T *r)
+{
+    if (r->hdr)
+        munmap((void *)r->hdr, r->size);
+    r->hdr = NULL;
+}
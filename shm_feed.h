@@ -0,0 +1,154 @@
+#ifndef SHM_FEED_H
+#define SHM_FEED_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "checker.h"
+
+/**
+ * @brief Default POSIX shared-memory object name of the detection feed.
+ */
+#define SHM_FEED_DEFAULT_NAME "/surv_feed"
+
+/**
+ * @brief Magic value identifying a detection feed segment ("SURF").
+ */
+#define SHM_FEED_MAGIC 0x53555246u
+
+/**
+ * @brief Layout version of the detection feed segment.
+ *
+ * Bumped whenever shmFeedHeader_T or shmFeedSlot_T change.
+ */
+#define SHM_FEED_VERSION 1u
+
+/**
+ * @brief Number of frames kept in the ring buffer.
+ */
+#define SHM_FEED_SLOTS 64u
+
+/**
+ * @brief Maximum number of detections stored per frame.
+ *
+ * Frames with more detections are truncated and flagged.
+ */
+#define SHM_FEED_MAX_DETECTIONS 1024u
+
+/**
+ * @brief One frame of detections in the ring buffer.
+ *
+ * Each slot is guarded by its own sequence counter (seqlock). The
+ * producer makes `seq` odd while it writes the slot and even again
+ * once the slot is complete, so after the n-th write of a slot its
+ * counter equals 2 * n. Readers never take a lock and never block
+ * the producer; they validate the counter after reading instead.
+ */
+typedef struct shmFeedSlot_T
+{
+  _Alignas(64) _Atomic uint64_t seq; /**< Sequence counter, odd while being written */
+  uint64_t frame;                    /**< Frame number of the producer */
+  uint64_t timestampNs;              /**< CLOCK_REALTIME of the frame in nanoseconds */
+  uint32_t count;                    /**< Number of valid entries in `detections` */
+  uint32_t truncated;                /**< Non-zero if the frame had more detections */
+  objectPosition_T detections[SHM_FEED_MAX_DETECTIONS]; /**< Object centers */
+} shmFeedSlot_T;
+
+/**
+ * @brief Layout of the shared-memory segment.
+ *
+ * `head` counts the frames published so far; frame number n
+ * (counting publications from 0) lives in slot n % slotCount.
+ */
+typedef struct shmFeedHeader_T
+{
+  _Atomic uint32_t magic; /**< SHM_FEED_MAGIC once the segment is initialized */
+  uint32_t version;       /**< SHM_FEED_VERSION */
+  uint32_t slotCount;     /**< Number of slots (SHM_FEED_SLOTS) */
+  uint32_t maxDetections; /**< Capacity of a slot (SHM_FEED_MAX_DETECTIONS) */
+  uint32_t S;             /**< Number of columns of the producer image */
+  uint32_t Z;             /**< Number of rows of the producer image */
+  _Alignas(64) _Atomic uint64_t head; /**< Number of published frames */
+  shmFeedSlot_T slots[SHM_FEED_SLOTS]; /**< Ring buffer */
+} shmFeedHeader_T;
+
+/**
+ * @brief Consumer-side handle of a detection feed.
+ */
+typedef struct shmFeedReader_T
+{
+  const shmFeedHeader_T *hdr; /**< Read-only mapping of the segment */
+  size_t size;                /**< Size of the mapping */
+  uint64_t next;              /**< Next publication index to read */
+  uint64_t lost;              /**< Frames overwritten before they were read */
+} shmFeedReader_T;
+
+/**
+ * @brief Creates the shared-memory segment and maps it for writing.
+ *
+ * An existing segment of the same name is replaced.
+ *
+ * @param name Shared-memory object name (e.g. SHM_FEED_DEFAULT_NAME)
+ * @param cols Number of columns of the image (S)
+ * @param rows Number of rows of the image (Z)
+ * @return 0 on success, non-zero on error
+ */
+int shm_feed_open(const char *name, unsigned int cols, unsigned int rows);
+
+/**
+ * @brief Publishes the detections of one frame.
+ *
+ * Never blocks. Readers that fall more than SHM_FEED_SLOTS frames
+ * behind lose the oldest frames.
+ *
+ * @param frame Frame number of the producer
+ * @param timestampNs CLOCK_REALTIME of the frame in nanoseconds
+ * @param dets Detected object centers
+ * @param count Number of entries in `dets`
+ */
+void shm_feed_publish(uint64_t frame, uint64_t timestampNs,
+                      const objectPosition_T *dets, int count);
+
+/**
+ * @brief Unmaps and unlinks the segment created by shm_feed_open().
+ */
+void shm_feed_close(void);
+
+/**
+ * @brief Maps an existing segment read-only.
+ *
+ * The reader starts at the most recently published frame.
+ *
+ * @return 0 on success, non-zero if the segment does not exist or
+ *         has an incompatible layout
+ */
+int shm_feed_reader_open(shmFeedReader_T *r, const char *name);
+
+/**
+ * @brief Starts reading the next frame in place.
+ *
+ * Returns a pointer into the shared mapping without copying. The
+ * slot may be overwritten at any time, so the data must be treated
+ * as tentative until shm_feed_end_read() confirms it.
+ *
+ * @param r Reader handle
+ * @param seq Receives the sequence counter to pass to shm_feed_end_read()
+ * @return Pointer to the slot, or NULL if no new frame is available
+ */
+const shmFeedSlot_T *shm_feed_begin_read(shmFeedReader_T *r, uint64_t *seq);
+
+/**
+ * @brief Finishes reading a slot returned by shm_feed_begin_read().
+ *
+ * @return 1 if the slot was not modified while it was read, 0 if it
+ *         was overwritten and the data must be discarded
+ */
+int shm_feed_end_read(shmFeedReader_T *r, const shmFeedSlot_T *slot, uint64_t seq);
+
+/**
+ * @brief Unmaps a reader.
+ */
+void shm_feed_reader_close(shmFeedReader_T *r);
+
+#endif /* SHM_FEED_H */
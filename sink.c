@@ -0,0 +1,408 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "sink.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+/* Size of the queue buffer of a sink */
+#define SINK_BUFFER_BYTES (1u << 20)
+/* Maximum number of queued records (and iovecs per writev) */
+#define SINK_MAX_RECORDS 1024
+/* Flush at the latest when the oldest queued frame is this old */
+#define SINK_MAX_DELAY_NS 1000000000ULL
+/* Minimum pause between reconnect attempts of a Unix socket sink */
+#define SINK_RECONNECT_NS 1000000000ULL
+
+typedef enum
+{
+    SINK_KIND_STDOUT,
+    SINK_KIND_FILE,
+    SINK_KIND_UNIX
+} sinkKind_T;
+
+struct sink_T
+{
+    sinkKind_T kind;
+    sinkFormat_T format;
+    unsigned int batch;
+    int fd;              /* -1 while disconnected */
+    int saved_flags;     /* original fcntl flags of stdout */
+    char spec[256];      /* specification string */
+    const char *path;    /* file or socket path inside spec */
+
+    char *buf;           /* queued bytes are buf[head, len) */
+    size_t head;
+    size_t len;
+    unsigned int rec[SINK_MAX_RECORDS]; /* unsent bytes per queued record */
+    uint64_t rec_ns[SINK_MAX_RECORDS];  /* queue time per queued record */
+    unsigned int rfirst;                /* ring index of the oldest record */
+    unsigned int nrec;                  /* number of queued records */
+
+    uint64_t oldest_ns;  /* queue time of the oldest record (rec_ns[rfirst]) */
+    uint64_t retry_ns;   /* earliest next reconnect attempt */
+    uint64_t dropped;    /* frames dropped */
+};
+
+static uint64_t mono_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Connect to a listening Unix stream socket, non-blocking */
+static int unix_connect(const char *path)
+{
+    struct sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path))
+        return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+/* Drop everything still queued (connection lost) */
+static void drop_queue(sink_T *k)
+{
+    k->dropped += k->nrec;
+    k->nrec = 0;
+    k->rfirst = 0;
+    k->head = k->len = 0;
+}
+
+/* Close the descriptor after a write error; Unix sinks reconnect later */
+static void disconnect(sink_T *k)
+{
+    if (k->kind != SINK_KIND_STDOUT)
+        close(k->fd);
+    k->fd = -1;
+    k->retry_ns = mono_ns() + SINK_RECONNECT_NS;
+    drop_queue(k);
+}
+
+sink_T *sink_open(const char *spec, sinkFormat_T format, unsigned int batch)
+{
+    sink_T *k = calloc(1, sizeof(*k));
+    if (!k)
+        return NULL;
+    if (strlen(spec) >= sizeof(k->spec))
+    {
+        free(k);
+        return NULL;
+    }
+    strcpy(k->spec, spec);
+    k->format = format;
+    k->batch = batch > 0 ? batch : 1;
+    k->saved_flags = -1;
+
+    if (strcmp(spec, "-") == 0 || strcmp(spec, "stdout") == 0)
+    {
+        k->kind = SINK_KIND_STDOUT;
+        k->fd = STDOUT_FILENO;
+        /* only pipes and sockets can stall us; never touch a tty or file */
+        struct stat st;
+        if (fstat(k->fd, &st) == 0 && (S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode)))
+        {
+            k->saved_flags = fcntl(k->fd, F_GETFL);
+            if (k->saved_flags >= 0)
+                fcntl(k->fd, F_SETFL, k->saved_flags | O_NONBLOCK);
+        }
+    }
+    else if (strncmp(spec, "file:", 5) == 0)
+    {
+        k->kind = SINK_KIND_FILE;
+        k->path = k->spec + 5;
+        k->fd = open(k->path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+    else if (strncmp(spec, "unix:", 5) == 0)
+    {
+        k->kind = SINK_KIND_UNIX;
+        k->path = k->spec + 5;
+        k->fd = unix_connect(k->path);
+    }
+    else
+    {
+        k->fd = -1;
+    }
+
+    k->buf = malloc(SINK_BUFFER_BYTES);
+    if (k->fd < 0 || !k->buf)
+    {
+        if (k->fd >= 0 && k->kind != SINK_KIND_STDOUT)
+            close(k->fd);
+        free(k->buf);
+        free(k);
+        return NULL;
+    }
+    return k;
+}
+
+/* One writev() over the queued records. Returns 1 if progress was made,
+   0 if the consumer is not ready, -1 on a broken connection. */
+static int flush_once(sink_T *k)
+{
+    struct iovec iov[SINK_MAX_RECORDS];
+    char *p = k->buf + k->head;
+    for (unsigned int i = 0; i < k->nrec; ++i)
+    {
+        unsigned int r = k->rec[(k->rfirst + i) % SINK_MAX_RECORDS];
+        iov[i].iov_base = p;
+        iov[i].iov_len = r;
+        p += r;
+    }
+
+    ssize_t w = writev(k->fd, iov, (int)k->nrec);
+    if (w < 0)
+    {
+        if (errno == EINTR)
+            return 1;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return 0;
+        return -1;
+    }
+
+    /* retire fully written records, keep the rest of a partial one */
+    size_t left = (size_t)w;
+    k->head += left;
+    while (left > 0)
+    {
+        unsigned int *r = &k->rec[k->rfirst];
+        if (left < *r)
+        {
+            *r -= (unsigned int)left;
+            break;
+        }
+        left -= *r;
+        k->rfirst = (k->rfirst + 1) % SINK_MAX_RECORDS;
+        k->nrec--;
+    }
+    if (k->nrec == 0)
+    {
+        k->rfirst = 0;
+        k->head = k->len = 0;
+    }
+    else
+    {
+        /* the flush deadline follows the record now at the front */
+        k->oldest_ns = k->rec_ns[k->rfirst];
+    }
+    return w > 0 ? 1 : 0;
+}
+
+int sink_flush(sink_T *k)
+{
+    if (k->fd < 0)
+    {
+        if (k->kind != SINK_KIND_UNIX || mono_ns() < k->retry_ns)
+            return k->nrec > 0;
+        k->fd = unix_connect(k->path);
+        if (k->fd < 0)
+        {
+            k->retry_ns = mono_ns() + SINK_RECONNECT_NS;
+            return 0;
+        }
+    }
+
+    while (k->nrec > 0)
+    {
+        int r = flush_once(k);
+        if (r < 0)
+        {
+            disconnect(k);
+            break;
+        }
+        if (r == 0)
+            break;
+    }
+    return k->nrec > 0;
+}
+
+/* Encode one record at buf + len. Returns its size, 0 if it does not fit. */
+static size_t encode(sink_T *k, uint64_t frame, uint64_t timestampNs,
+                     const objectPosition_T *dets, int count)
+{
+    char *out = k->buf + k->len;
+    size_t avail = SINK_BUFFER_BYTES - k->len;
+
+    if (k->format == SINK_FORMAT_BINARY)
+    {
+        size_t payload = sizeof(objectPosition_T) * (size_t)count;
+        if (sizeof(sinkRecordHeader_T) + payload > avail)
+            return 0;
+        sinkRecordHeader_T h = {SINK_RECORD_MAGIC, (uint32_t)count, frame, timestampNs};
+        memcpy(out, &h, sizeof(h));
+        memcpy(out + sizeof(h), dets, payload);
+        return sizeof(h) + payload;
+    }
+
+    size_t n = 0;
+    int w = snprintf(out, avail, "{\"frame\":%llu,\"ts\":%llu,\"objects\":[",
+                     (unsigned long long)frame, (unsigned long long)timestampNs);
+    if (w < 0 || (size_t)w >= avail)
+        return 0;
+    n += (size_t)w;
+    for (int i = 0; i < count; ++i)
+    {
+        w = snprintf(out + n, avail - n, "%s[%.3f,%.3f]", i ? "," : "",
+                     dets[i].s, dets[i].z);
+        if (w < 0 || (size_t)w >= avail - n)
+            return 0;
+        n += (size_t)w;
+    }
+    if (avail - n < 4)
+        return 0;
+    memcpy(out + n, "]}\n", 3);
+    return n + 3;
+}
+
+/* Reclaim space in front of the queue before appending */
+static void compact(sink_T *k)
+{
+    if (k->head > 0 && k->nrec > 0)
+    {
+        memmove(k->buf, k->buf + k->head, k->len - k->head);
+        k->len -= k->head;
+        k->head = 0;
+    }
+}
+
+/* Queue the `n` bytes just encoded at buf + len; n == 0 means the record
+   did not fit. Returns 0 if queued, 1 if dropped. */
+static int commit_record(sink_T *k, size_t n)
+{
+    if (n == 0)
+    {
+        /* consumer too slow (or gone): keep what is queued, drop this record */
+        k->dropped++;
+        sink_flush(k);
+        return 1;
+    }
+
+    uint64_t now = mono_ns();
+    unsigned int slot = (k->rfirst + k->nrec) % SINK_MAX_RECORDS;
+    k->rec[slot] = (unsigned int)n;
+    k->rec_ns[slot] = now;
+    k->nrec++;
+    k->len += n;
+
+    if (k->nrec == 1)
+        k->oldest_ns = now;
+    if (k->nrec >= k->batch || now - k->oldest_ns >= SINK_MAX_DELAY_NS)
+        sink_flush(k);
+    return 0;
+}
+
+int sink_write_frame(sink_T *k, uint64_t frame, uint64_t timestampNs,
+                     const objectPosition_T *dets, int count)
+{
+    if (count < 0)
+        count = 0;
+    compact(k);
+    size_t n = 0;
+    if (k->fd >= 0 && k->nrec < SINK_MAX_RECORDS)
+        n = encode(k, frame, timestampNs, dets, count);
+    return commit_record(k, n);
+}
+
+/* Encode one crossing event at buf + len. Returns its size, 0 if it does not fit. */
+static size_t encode_event(sink_T *k, const edgeEvent_T *ev)
+{
+    char *out = k->buf + k->len;
+    size_t avail = SINK_BUFFER_BYTES - k->len;
+
+    if (k->format == SINK_FORMAT_BINARY)
+    {
+        if (sizeof(sinkEventRecord_T) > avail)
+            return 0;
+        sinkEventRecord_T r = {SINK_EVENT_MAGIC, (uint32_t)ev->side, ev->segment,
+                               (uint32_t)ev->direction, ev->frame, ev->timestampNs, ev->pos, 0};
+        memcpy(out, &r, sizeof(r));
+        return sizeof(r);
+    }
+
+    int w = snprintf(out, avail,
+                     "{\"event\":\"%s\",\"frame\":%llu,\"ts\":%llu,\"edge\":\"%s\",\"segment\":%u,\"pos\":%.3f}\n",
+                     ev->direction == EDGE_DIR_IN ? "in" : "out",
+                     (unsigned long long)ev->frame, (unsigned long long)ev->timestampNs,
+                     edge_side_name(ev->side), ev->segment, ev->pos);
+    if (w < 0 || (size_t)w >= avail)
+        return 0;
+    return (size_t)w;
+}
+
+int sink_write_event(sink_T *k, const edgeEvent_T *ev)
+{
+    compact(k);
+    size_t n = 0;
+    if (k->fd >= 0 && k->nrec < SINK_MAX_RECORDS)
+        n = encode_event(k, ev);
+    return commit_record(k, n);
+}
+
+int sink_poll(sink_T *k)
+{
+    if (k->nrec > 0 && mono_ns() - k->oldest_ns >= SINK_MAX_DELAY_NS)
+        return sink_flush(k);
+    return k->nrec > 0;
+}
+
+uint64_t sink_dropped(const sink_T *k)
+{
+    return k->dropped;
+}
+
+const char *sink_name(const sink_T *k)
+{
+    return k->spec;
+}
+
+uint64_t sink_close(sink_T *k)
+{
+    if (!k)
+        return 0;
+
+    /* give a slow consumer up to a second to take the rest */
+    uint64_t deadline = mono_ns() + SINK_MAX_DELAY_NS;
+    while (k->fd >= 0 && sink_flush(k) && mono_ns() < deadline)
+    {
+        struct pollfd pfd = {.fd = k->fd, .events = POLLOUT};
+        poll(&pfd, 1, 100);
+    }
+    k->dropped += k->nrec;
+
+    if (k->kind == SINK_KIND_STDOUT)
+    {
+        if (k->saved_flags >= 0)
+            fcntl(STDOUT_FILENO, F_SETFL, k->saved_flags);
+    }
+    else if (k->fd >= 0)
+    {
+        close(k->fd);
+    }
+    uint64_t dropped = k->dropped;
+    free(k->buf);
+    free(k);
+    return dropped;
+}
@@ -0,0 +1,138 @@
+#ifndef SINK_H
+#define SINK_H
+
+#include <stdint.h>
+
+#include "checker.h"
+#include "edge_analytics.h"
+
+/**
+ * @brief Encoding of the per-frame records written to a sink.
+ */
+typedef enum sinkFormat_T
+{
+  SINK_FORMAT_JSON,  /**< One JSON object per line */
+  SINK_FORMAT_BINARY /**< sinkRecordHeader_T followed by the centers, or sinkEventRecord_T */
+} sinkFormat_T;
+
+/**
+ * @brief Magic value starting every binary record ("SURV").
+ */
+#define SINK_RECORD_MAGIC 0x56525553u
+
+/**
+ * @brief Header of a binary record.
+ *
+ * Followed by `count` objectPosition_T entries. All fields use the
+ * native byte order of the producer.
+ */
+typedef struct sinkRecordHeader_T
+{
+  uint32_t magic;       /**< SINK_RECORD_MAGIC */
+  uint32_t count;       /**< Number of object centers following the header */
+  uint64_t frame;       /**< Frame number */
+  uint64_t timestampNs; /**< CLOCK_REALTIME of the frame in nanoseconds */
+} sinkRecordHeader_T;
+
+/**
+ * @brief Magic value starting every binary crossing event ("SEVT").
+ */
+#define SINK_EVENT_MAGIC 0x54564553u
+
+/**
+ * @brief Binary record of a border crossing (edge-only mode).
+ */
+typedef struct sinkEventRecord_T
+{
+  uint32_t magic;       /**< SINK_EVENT_MAGIC */
+  uint32_t side;        /**< edgeSide_T */
+  uint32_t segment;     /**< Segment of the side */
+  uint32_t direction;   /**< edgeDirection_T */
+  uint64_t frame;       /**< Frame in which the crossing completed */
+  uint64_t timestampNs; /**< CLOCK_REALTIME of that frame in nanoseconds */
+  float pos;            /**< Column or row of the crossing */
+  uint32_t reserved;    /**< Zero */
+} sinkEventRecord_T;
+
+/**
+ * @brief Output sink with a batching write buffer.
+ *
+ * Records are queued in a fixed-size buffer and written in batches
+ * with a single writev() per flush. Stdout (when it is a pipe or a
+ * socket) and Unix sockets are written non-blocking: if the consumer
+ * cannot keep up and the buffer is full, new frames are dropped and
+ * counted instead of stalling the detection loop.
+ */
+typedef struct sink_T sink_T;
+
+/**
+ * @brief Opens a sink.
+ *
+ * Accepted specifications:
+ * - `-` or `stdout`: standard output
+ * - `file:PATH`: regular file (created or truncated)
+ * - `unix:PATH`: connect to a listening Unix stream socket
+ *
+ * @param spec Sink specification
+ * @param format Record encoding
+ * @param batch Number of frames collected before a flush (>= 1)
+ * @return New sink, or NULL on error
+ */
+sink_T *sink_open(const char *spec, sinkFormat_T format, unsigned int batch);
+
+/**
+ * @brief Queues the detections of one frame.
+ *
+ * Flushes when `batch` frames are queued or the oldest queued frame
+ * is older than one second.
+ *
+ * @return 0 if the frame was queued, 1 if it was dropped
+ */
+int sink_write_frame(sink_T *sink, uint64_t frame, uint64_t timestampNs,
+                     const objectPosition_T *dets, int count);
+
+/**
+ * @brief Queues one border crossing event.
+ *
+ * JSON events are lines of the form
+ * `{"event":"in","frame":N,"ts":NS,"edge":"left","segment":0,"pos":12.500}`.
+ *
+ * @return 0 if the event was queued, 1 if it was dropped
+ */
+int sink_write_event(sink_T *sink, const edgeEvent_T *event);
+
+/**
+ * @brief Flushes if the oldest queued record has waited for one second.
+ *
+ * For producers that write rarely, such as the crossing events of
+ * edge-only mode.
+ *
+ * @return 0 if the queue is empty afterwards, 1 if data is still pending
+ */
+int sink_poll(sink_T *sink);
+
+/**
+ * @brief Writes as much of the queued data as the consumer accepts.
+ *
+ * @return 0 if the queue is empty afterwards, 1 if data is still pending
+ */
+int sink_flush(sink_T *sink);
+
+/**
+ * @brief Number of records (frames or events) dropped because the consumer was too slow.
+ */
+uint64_t sink_dropped(const sink_T *sink);
+
+/**
+ * @brief Specification string the sink was opened with.
+ */
+const char *sink_name(const sink_T *sink);
+
+/**
+ * @brief Flushes remaining data (waiting up to one second) and closes the sink.
+ *
+ * @return Total number of records dropped over the lifetime of the sink
+ */
+uint64_t sink_close(sink_T *sink);
+
+#endif /* SINK_H */
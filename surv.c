@@ -6,10 +6,29 @@
 #include <pthread.h>
 
 #include "checker.h"
+#include "shm_feed.h"
+#include "sink.h"
+#include "tasks.h"
+#include "sat.h"
+#include "tile.h"
+#include "trace.h"
+#include "scenario.h"
+#include "edge_analytics.h"
+#ifdef SURV_ALLOC_TEST
+#include "alloc_count.h"
+#endif
 #include <string.h>
 #include <math.h>
+#include <stdint.h>
 
 static volatile int keep_running = 1;
+/* Stop after this many frames (--frames); 0 runs until interrupted */
+static uint64_t max_frames = 0;
+
+/* Output sinks of the detection results */
+#define SURV_MAX_SINKS 4
+static sink_T *sinks[SURV_MAX_SINKS];
+static int num_sinks = 0;
 
 static void sigint_handler(int sig)
 {
@@ -23,6 +42,14 @@ static void msleep(unsigned int ms)
     nanosleep(&ts, NULL);
 }
 
+/* Wall-clock timestamp of a frame in nanoseconds */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
 /* Map coverage to a display character */
 static int cov_char(coverage_T c)
 {
@@ -37,278 +64,653 @@ static int cov_char(coverage_T c)
     return '@';
 }
 
-/* Types and worker moved to file scope so we don't define nested functions */
+/* Types and task bodies live at file scope so we don't define nested functions */
 typedef struct
 {
     unsigned int s;
     unsigned int z;
 } coord_t;
+
+/* Edge scan: one result slot per border coordinate */
+typedef struct
+{
+    const coord_t *coords;
+    coverage_T *res;
+} edge_ctx_t;
+
+static void edge_task(int begin, int end, void *arg)
+{
+    edge_ctx_t *ec = (edge_ctx_t *)arg;
+    TRACE_BEGIN("edge_worker");
+    for (int i = begin; i < end; ++i)
+        ec->res[i] = check(ec->coords[i].s, ec->coords[i].z);
+    TRACE_END("edge_worker");
+}
+
+/* Ring scan of edge-only mode: one result slot per ring pixel */
 typedef struct
 {
-    coord_t *coords;
-    int start, end;
-} worker_arg_t;
+    const edgePixel_T *pixels;
+    coverage_T *res;
+} ring_ctx_t;
+
+static void ring_task(int begin, int end, void *arg)
+{
+    ring_ctx_t *rc = (ring_ctx_t *)arg;
+    TRACE_BEGIN("ring_worker");
+    for (int i = begin; i < end; ++i)
+        rc->res[i] = check(rc->pixels[i].s, rc->pixels[i].z);
+    TRACE_END("ring_worker");
+}
+
+/* Coverage fill: one task item per image row, which crosses every tile
+   of its tile row */
 typedef struct
 {
-    occupiedPixel_T *res;
-    int count;
-} worker_res_t;
+    const tileLayout_T *layout;
+    coverage_T *grid;
+    int *label;
+} fill_ctx_t;
 
-static void *edge_worker(void *arg)
+static void fill_task(int begin, int end, void *arg)
 {
-    worker_arg_t *wa = (worker_arg_t *)arg;
-    int cap = wa->end - wa->start;
-    if (cap <= 0)
+    fill_ctx_t *fc = (fill_ctx_t *)arg;
+    TRACE_BEGIN("fill rows");
+    for (int z = begin; z < end; ++z)
     {
-        worker_res_t *empty = malloc(sizeof(worker_res_t));
-        empty->res = NULL;
-        empty->count = 0;
-        return empty;
+        for (unsigned int s0 = 0; s0 < S; s0 += TILE_DIM)
+        {
+            size_t row = tile_index(fc->layout, s0, (unsigned int)z);
+            unsigned int w = S - s0 < TILE_DIM ? S - s0 : TILE_DIM;
+            for (unsigned int ls = 0; ls < w; ++ls)
+            {
+                fc->grid[row + ls] = check(s0 + ls, (unsigned int)z);
+                fc->label[row + ls] = -1;
+            }
+        }
     }
+    TRACE_END("fill rows");
+}
 
-    occupiedPixel_T *local = malloc(sizeof(occupiedPixel_T) * cap);
-    int cnt = 0;
-    for (int i = wa->start; i < wa->end; ++i)
+/* Connected component of the labeling stage. Each band of a tile
+   numbers its components starting at the index of its first element,
+   so labels are unique per frame. `first` is the raster index (z * S + s) of the
+   component's first pixel in raster order; merges keep the smaller one
+   as root, so sorting roots by it restores raster order. */
+typedef struct
+{
+    float sumA, sumX, sumY; /* coverage mass and first moments */
+    int parent;             /* union-find link for merges across bands and tiles */
+    unsigned int first;     /* raster index of the first pixel */
+} comp_t;
+
+/* Labeling: one task item per band of `band_rows` rows of a tile, so
+   small frames with few tiles still spread over all workers */
+typedef struct
+{
+    const tileLayout_T *layout;
+    const coverage_T *grid;
+    int *label;
+    int *stack;
+    comp_t *comps;
+    int *ncomp; /* number of components per band */
+    int bands;  /* bands per tile */
+} label_ctx_t;
+
+static void label_task(int begin, int end, void *arg)
+{
+    label_ctx_t *lc = (label_ctx_t *)arg;
+    const coverage_T *grid = lc->grid;
+    int *label = lc->label;
+    int band_rows = (int)TILE_DIM / lc->bands;
+    TRACE_BEGIN("label bands");
+    tileIter_T it;
+    it.slot = (unsigned int)-1;
+    for (int item = begin; item < end; ++item)
     {
-        unsigned int cs = wa->coords[i].s;
-        unsigned int cz = wa->coords[i].z;
-        coverage_T c = check(cs, cz);
-        if (c > 0)
+        unsigned int slot = (unsigned int)(item / lc->bands);
+        if (slot != it.slot)
         {
-            local[cnt].s = cs;
-            local[cnt].z = cz;
-            local[cnt].coverage = c;
-            cnt++;
+            tile_iter_init(&it, lc->layout, slot, slot + 1);
+            tile_iter_next(&it);
         }
+        int z0 = (item % lc->bands) * band_rows;
+        int z1 = z0 + band_rows < (int)it.h ? z0 + band_rows : (int)it.h;
+        int base = (int)it.base + (z0 << TILE_SHIFT);
+        int w = (int)it.w;
+        int *stack = lc->stack + base; /* bands own disjoint stack regions */
+        int n = 0;
+
+        for (int lz0 = z0; lz0 < z1; ++lz0)
+        {
+            for (int ls0 = 0; ls0 < w; ++ls0)
+            {
+                int idx0 = (int)it.base + (lz0 << TILE_SHIFT) + ls0;
+                if (label[idx0] >= 0 || grid[idx0] <= 0)
+                    continue;
+                /* DFS flood-fill restricted to the band */
+                int id = base + n++;
+                comp_t *cp = &lc->comps[id];
+                int sp = 0;
+                stack[sp++] = idx0;
+                label[idx0] = id;
+                float sumA = 0.0f, sumX = 0.0f, sumY = 0.0f;
+                while (sp > 0)
+                {
+                    int idx = stack[--sp];
+                    int lz = (idx - (int)it.base) >> TILE_SHIFT;
+                    int ls = (idx - (int)it.base) & (TILE_DIM - 1);
+                    float a = grid[idx] / 100.0f;
+                    sumA += a;
+                    sumX += a * ((int)it.s0 + ls + 0.5f);
+                    sumY += a * ((int)it.z0 + lz + 0.5f);
+                    /* 4-neighbors; the one below is only TILE_DIM away */
+                    int nidx;
+                    if (ls - 1 >= 0)
+                    {
+                        nidx = idx - 1;
+                        if (label[nidx] < 0 && grid[nidx] > 0)
+                        {
+                            label[nidx] = id;
+                            stack[sp++] = nidx;
+                        }
+                    }
+                    if (ls + 1 < w)
+                    {
+                        nidx = idx + 1;
+                        if (label[nidx] < 0 && grid[nidx] > 0)
+                        {
+                            label[nidx] = id;
+                            stack[sp++] = nidx;
+                        }
+                    }
+                    if (lz - 1 >= z0)
+                    {
+                        nidx = idx - (int)TILE_DIM;
+                        if (label[nidx] < 0 && grid[nidx] > 0)
+                        {
+                            label[nidx] = id;
+                            stack[sp++] = nidx;
+                        }
+                    }
+                    if (lz + 1 < z1)
+                    {
+                        nidx = idx + (int)TILE_DIM;
+                        if (label[nidx] < 0 && grid[nidx] > 0)
+                        {
+                            label[nidx] = id;
+                            stack[sp++] = nidx;
+                        }
+                    }
+                }
+                cp->sumA = sumA;
+                cp->sumX = sumX;
+                cp->sumY = sumY;
+                cp->parent = id;
+                cp->first = (it.z0 + (unsigned int)lz0) * S + it.s0 + (unsigned int)ls0;
+            }
+        }
+        lc->ncomp[item] = n;
     }
-    worker_res_t *wr = malloc(sizeof(worker_res_t));
-    wr->res = local;
-    wr->count = cnt;
-    return wr;
+    TRACE_END("label bands");
 }
 
-int main(int argc, char **argv)
+/* Union-find root with path halving */
+static int comp_find(comp_t *comps, int i)
 {
-    int demo_mode = 0;
-    for (int i = 1; i < argc; ++i)
+    while (comps[i].parent != i)
     {
-        if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--demo") == 0)
-            demo_mode = 1;
+        comps[i].parent = comps[comps[i].parent].parent;
+        i = comps[i].parent;
     }
+    return i;
+}
 
-    signal(SIGINT, sigint_handler);
+/* Join the components of two touching pixels; the root with the earlier
+   first pixel wins so the merged component keeps its raster order */
+static void comp_union(comp_t *comps, int a, int b)
+{
+    if (a < 0 || b < 0)
+        return;
+    int ra = comp_find(comps, a);
+    int rb = comp_find(comps, b);
+    if (ra == rb)
+        return;
+    if (comps[ra].first < comps[rb].first)
+        comps[rb].parent = ra;
+    else
+        comps[ra].parent = rb;
+}
 
-    if (init() != 0)
+/* In-place heapsort; unlike qsort() it never touches the heap */
+static void sort_keys(uint64_t *a, int n)
+{
+    for (int start = n / 2 - 1, end = n; end > 1;)
     {
-        fprintf(stderr, "Failed to initialize checker framework\n");
-        return 1;
+        int root;
+        if (start >= 0)
+            root = start--;
+        else
+        {
+            uint64_t t = a[0];
+            a[0] = a[--end];
+            a[end] = t;
+            root = 0;
+        }
+        for (int child; (child = 2 * root + 1) < end; root = child)
+        {
+            if (child + 1 < end && a[child + 1] > a[child])
+                child++;
+            if (a[root] >= a[child])
+                break;
+            uint64_t t = a[root];
+            a[root] = a[child];
+            a[child] = t;
+        }
     }
+}
 
-    /* If demo mode is enabled, spawn a few objects coming in from edges */
-    if (demo_mode)
+/* Buffers shared by all stages of a frame. Sized for the current S x Z
+   and reused every cycle, so the steady-state loop does not touch the
+   heap; they are reallocated only when the resolution changes. The
+   per-pixel buffers use the tiled layout of `tiles` and live in page
+   (or huge page) aligned mappings. */
+typedef struct
+{
+    int ready;              /* buffers match S, Z and the mode */
+    unsigned int S, Z;      /* resolution the buffers are sized for */
+    int R;                  /* number of edge coordinates */
+    coord_t *coords;        /* edge coordinates, built once per resolution */
+    coverage_T *edge_cov;   /* edge scan result per coordinate */
+    tileLayout_T tiles;     /* layout of the per-pixel buffers */
+    tileBuffer_T grid_buf, label_buf, stack_buf, comps_buf;
+    coverage_T *grid;       /* coverage of every pixel */
+    int *label;             /* component label per pixel, -1 if unlabeled */
+    int *stack;             /* flood-fill stacks, one region per tile */
+    comp_t *comps;          /* component accumulators indexed by label */
+    int *ncomp;             /* components per labeling band */
+    int tile_bands;         /* labeling bands per tile */
+    uint64_t *roots;        /* first pixel and label of each root, for sorting */
+    objectPosition_T *dets; /* detections of the frame */
+    objectPosition_T *objs; /* display copy of the detected-list */
+    coverageTable_T sat[2]; /* summed-area tables; one published, one being built */
+    int sat_front;          /* index of the published table */
+    edgeAnalytics_T *ea;    /* border tracking of edge-only mode */
+    coverage_T *ring_cov;   /* ring scan result per ring pixel */
+} frame_ws_t;
+
+static frame_ws_t ws;
+/* Pyramid levels of the summed-area tables (--pyramid) */
+static unsigned int sat_levels = 0;
+/* Store frame tiles in Morton order (--morton) */
+static int tile_morton = 0;
+/* Edge-only analytics mode (--edge-only) and its segments per side */
+static int edge_only = 0;
+static unsigned int edge_segments = 1;
+
+/* Release all workspace buffers */
+static void ws_free(void)
+{
+    setCoverageTable(NULL);
+    sat_free(&ws.sat[0]);
+    sat_free(&ws.sat[1]);
+    free(ws.coords);
+    free(ws.edge_cov);
+    tile_buffer_free(&ws.grid_buf);
+    tile_buffer_free(&ws.label_buf);
+    tile_buffer_free(&ws.stack_buf);
+    tile_buffer_free(&ws.comps_buf);
+    tile_layout_free(&ws.tiles);
+    free(ws.ncomp);
+    free(ws.roots);
+    free(ws.dets);
+    free(ws.objs);
+    edge_analytics_free(ws.ea);
+    free(ws.ring_cov);
+    memset(&ws, 0, sizeof(ws));
+}
+
+/* Make the workspace fit the current resolution. A no-op unless S or Z
+   changed since the last call. Edge-only mode needs just the border
+   ring, so none of the full-frame buffers are allocated. Returns 0 on
+   success, -1 if memory is exhausted (or the image is too small for
+   edge-only mode). */
+static int ws_reserve(void)
+{
+    if (ws.ready && ws.S == S && ws.Z == Z)
+        return 0;
+    ws_free();
+
+    if (edge_only)
     {
-        /* left -> right */
-        addObject(-0.5f, (float)Z * 0.25f, 0.6f, 0.0f);
-        /* right -> left */
-        addObject((float)S + 0.5f, (float)Z * 0.55f, -0.5f, 0.0f);
-        /* top -> down */
-        addObject((float)S * 0.33f, -0.5f, 0.0f, 0.5f);
-        /* bottom -> up */
-        addObject((float)S * 0.66f, (float)Z + 0.5f, 0.0f, -0.45f);
+        ws.ea = edge_analytics_create(S, Z, edge_segments);
+        if (!ws.ea)
+            return -1;
+        ws.ring_cov = malloc(sizeof(coverage_T) * (size_t)edge_analytics_ring_size(ws.ea));
+        if (!ws.ring_cov)
+        {
+            ws_free();
+            return -1;
+        }
+        ws.S = S;
+        ws.Z = Z;
+        ws.ready = 1;
+        return 0;
     }
 
-    /* Initialize ncurses */
-    initscr();
-    cbreak();
-    noecho();
-    curs_set(0);
-    nodelay(stdscr, TRUE);
-    keypad(stdscr, TRUE);
-
-    /* Main loop: check all edge pixels in parallel (up to 4 threads) */
-    while (keep_running)
+    size_t N = (size_t)S * (size_t)Z;
+    int maxR = 2 * S + 2 * ((int)Z > 2 ? (int)Z - 2 : 0);
+    if (tile_layout_init(&ws.tiles, S, Z, tile_morton) != 0)
+        return -1;
+    size_t P = tile_elements(&ws.tiles); /* N plus the padding of border tiles */
+    ws.coords = malloc(sizeof(coord_t) * maxR);
+    ws.edge_cov = malloc(sizeof(coverage_T) * maxR);
+    /* Enough labeling items to keep every worker busy on small frames */
+    ws.tile_bands = 1;
+    while (ws.tile_bands < (int)TILE_DIM &&
+           (int)ws.tiles.ntiles * ws.tile_bands < 4 * tasks_worker_count())
+        ws.tile_bands *= 2;
+    ws.ncomp = malloc(sizeof(int) * (ws.tiles.ntiles ? ws.tiles.ntiles : 1) * (size_t)ws.tile_bands);
+    ws.roots = malloc(sizeof(uint64_t) * (N ? N : 1));
+    ws.dets = malloc(sizeof(objectPosition_T) * N);
+    ws.objs = malloc(sizeof(objectPosition_T) * N);
+    if (tile_buffer_alloc(&ws.grid_buf, sizeof(coverage_T) * P) != 0 ||
+        tile_buffer_alloc(&ws.label_buf, sizeof(int) * P) != 0 ||
+        tile_buffer_alloc(&ws.stack_buf, sizeof(int) * P) != 0 ||
+        tile_buffer_alloc(&ws.comps_buf, sizeof(comp_t) * P) != 0 ||
+        !ws.coords || !ws.edge_cov || !ws.ncomp || !ws.roots || !ws.dets || !ws.objs ||
+        reserveDetectedObjects((int)N) != 0 ||
+        sat_init(&ws.sat[0], S, Z, sat_levels) != 0 ||
+        sat_init(&ws.sat[1], S, Z, sat_levels) != 0)
     {
-        /* Build list of edge coordinates */
-        int R = 0;
-        /* Upper bound allocation */
-        int maxR = 2 * S + 2 * ((int)Z > 2 ? (int)Z - 2 : 0);
-        coord_t *coords = malloc(sizeof(coord_t) * maxR);
-        if (!coords)
-            break;
+        ws_free();
+        return -1;
+    }
+    ws.grid = ws.grid_buf.data;
+    ws.label = ws.label_buf.data;
+    ws.stack = ws.stack_buf.data;
+    ws.comps = ws.comps_buf.data;
 
-        /* Top row */
+    /* Build list of edge coordinates */
+    int R = 0;
+    /* Top row */
+    for (unsigned int s = 0; s < S; ++s)
+        ws.coords[R++] = (coord_t){s, 0};
+    /* Bottom row */
+    if (Z > 1)
         for (unsigned int s = 0; s < S; ++s)
-            coords[R++] = (coord_t){s, 0};
-        /* Bottom row */
-        if (Z > 1)
-            for (unsigned int s = 0; s < S; ++s)
-                coords[R++] = (coord_t){s, Z - 1};
-        /* Left/Right columns excluding corners */
-        if (Z > 2)
+            ws.coords[R++] = (coord_t){s, Z - 1};
+    /* Left/Right columns excluding corners */
+    if (Z > 2)
+    {
+        for (unsigned int z = 1; z < Z - 1; ++z)
         {
-            for (unsigned int z = 1; z < Z - 1; ++z)
-            {
-                coords[R++] = (coord_t){0, z};
-                if (S > 1)
-                    coords[R++] = (coord_t){S - 1, z};
-            }
+            ws.coords[R++] = (coord_t){0, z};
+            if (S > 1)
+                ws.coords[R++] = (coord_t){S - 1, z};
         }
+    }
+    ws.R = R;
+    ws.S = S;
+    ws.Z = Z;
+    ws.ready = 1;
+    return 0;
+}
 
-        /* Prepare for parallel checking */
-        numberOfOccupiedPixels = 0; /* will be set after aggregation */
-        int num_threads = 4;
-        if (R < num_threads)
-            num_threads = R > 0 ? R : 1;
-
-        pthread_t threads[4];
-        worker_arg_t args[4];
+/* Run one detection cycle: scan the image edge into `occupiedPixels`,
+   fill the coverage grid and label connected components. All stages
+   are split into chunks and balanced across the task pool. Results are
+   left in the workspace (`ws.grid`, `ws.dets`). Returns the number of
+   detections, or -1 if the workspace could not be allocated. */
+static int detect_frame(void)
+{
+    if (ws_reserve() != 0)
+        return -1;
 
-        int base = 0;
-        int per = R / num_threads;
-        int rem = R % num_threads;
-        for (int t = 0; t < num_threads; ++t)
+    /* Check all edge pixels in parallel, then collect the occupied ones */
+    TRACE_BEGIN("edge scan");
+    edge_ctx_t ec = {ws.coords, ws.edge_cov};
+    tasks_parallel_for(ws.R, 16, edge_task, &ec);
+    int total = 0;
+    for (int i = 0; i < ws.R && total < (int)(S * Z); ++i)
+    {
+        if (ws.edge_cov[i] > 0)
         {
-            int st = base;
-            int en = st + per + (t < rem ? 1 : 0);
-            base = en;
-            args[t].coords = (coord_t *)coords;
-            args[t].start = st;
-            args[t].end = en;
-            pthread_create(&threads[t], NULL, edge_worker, &args[t]);
+            occupiedPixels[total].s = ws.coords[i].s;
+            occupiedPixels[total].z = ws.coords[i].z;
+            occupiedPixels[total].coverage = ws.edge_cov[i];
+            total++;
         }
+    }
+    numberOfOccupiedPixels = total;
+    TRACE_END("edge scan");
 
-        /* Aggregate results */
-        int total = 0;
-        for (int t = 0; t < num_threads; ++t)
+    /* Object detection: find connected components of occupied pixels and compute one centroid per component */
+    const tileLayout_T *tl = &ws.tiles;
+    int bands = ws.tile_bands;
+    int band_rows = (int)TILE_DIM / bands;
+    int nitems = (int)tl->ntiles * bands;
+    int *label = ws.label;
+    comp_t *comps = ws.comps;
+
+    /* Fill coverage grid, one row per task item */
+    TRACE_BEGIN("coverage fill");
+    fill_ctx_t fc = {tl, ws.grid, label};
+    tasks_parallel_for((int)Z, 1, fill_task, &fc);
+    TRACE_END("coverage fill");
+
+    /* Integral image of the coverage for constant-time region queries.
+       Build the table readers are not using, then swap it in. */
+    TRACE_BEGIN("sat build");
+    coverageTable_T *table = &ws.sat[ws.sat_front ^ 1];
+    sat_build_tiled(table, tl, ws.grid);
+    setCoverageTable(table);
+    ws.sat_front ^= 1;
+    TRACE_END("sat build");
+
+    /* Label each band of each tile independently */
+    TRACE_BEGIN("labeling");
+    label_ctx_t lc = {tl, ws.grid, label, ws.stack, comps, ws.ncomp, bands};
+    tasks_parallel_for(nitems, 1, label_task, &lc);
+
+    /* Merge components touching across band borders inside a tile and
+       across the right and bottom tile borders */
+    tileIter_T it;
+    tile_iter_init(&it, tl, 0, tl->ntiles);
+    while (tile_iter_next(&it))
+    {
+        for (unsigned int lz = (unsigned int)band_rows; lz < it.h; lz += (unsigned int)band_rows)
         {
-            worker_res_t *wr;
-            pthread_join(threads[t], (void **)&wr);
-            if (wr)
-            {
-                for (int k = 0; k < wr->count; ++k)
-                {
-                    if (total < (int)(S * Z))
-                    {
-                        occupiedPixels[total] = wr->res[k];
-                        total++;
-                    }
-                }
-                free(wr->res);
-                free(wr);
-            }
+            size_t below = it.base + ((size_t)lz << TILE_SHIFT);
+            for (unsigned int ls = 0; ls < it.w; ++ls)
+                comp_union(comps, label[below - TILE_DIM + ls], label[below + ls]);
         }
-        numberOfOccupiedPixels = total;
-
-        /* Object detection: find connected components of occupied pixels and compute one centroid per component */
-        int N = (int)S * (int)Z;
-        float *cov = malloc(sizeof(float) * (size_t)N);
-        unsigned char *vis = malloc((size_t)N);
-        int *stack = malloc(sizeof(int) * (size_t)N);
-        if (!cov || !vis || !stack)
+        if (it.ts + 1 < tl->tilesS)
         {
-            free(cov);
-            free(vis);
-            free(stack);
-            continue; /* skip this cycle if memory allocation fails */
+            size_t right = (size_t)tl->slot[it.tz * tl->tilesS + it.ts + 1] * TILE_AREA;
+            for (unsigned int lz = 0; lz < it.h; ++lz)
+                comp_union(comps, label[it.base + (lz << TILE_SHIFT) + TILE_DIM - 1],
+                           label[right + (lz << TILE_SHIFT)]);
         }
-        /* Fill coverage grid */
-        for (unsigned int z = 0; z < Z; ++z)
+        if (it.tz + 1 < tl->tilesZ)
         {
-            for (unsigned int s = 0; s < S; ++s)
-            {
-                int idx = (int)z * (int)S + (int)s;
-                coverage_T cc = check(s, z);
-                cov[idx] = cc / 100.0f;
-                vis[idx] = 0;
-            }
+            size_t below = (size_t)tl->slot[(it.tz + 1) * tl->tilesS + it.ts] * TILE_AREA;
+            size_t last = it.base + ((size_t)(TILE_DIM - 1) << TILE_SHIFT);
+            for (unsigned int ls = 0; ls < it.w; ++ls)
+                comp_union(comps, label[last + ls], label[below + ls]);
         }
+    }
 
-        objectPosition_T *dets = malloc(sizeof(objectPosition_T) * (size_t)N);
-        int det_count = 0;
-
-        for (int idx0 = 0; idx0 < N; ++idx0)
+    /* Fold merged components into their roots */
+    for (int t = 0; t < nitems; ++t)
+    {
+        int base = t * band_rows * (int)TILE_DIM;
+        for (int id = base; id < base + ws.ncomp[t]; ++id)
         {
-            if (vis[idx0] || cov[idx0] <= 0.0f)
+            int r = comp_find(comps, id);
+            if (r == id)
                 continue;
-            /* BFS flood-fill */
-            int sp = 0;
-            stack[sp++] = idx0;
-            vis[idx0] = 1;
-            float sumA = 0.0f, sumX = 0.0f, sumY = 0.0f;
-            while (sp > 0)
-            {
-                int idx = stack[--sp];
-                int z = idx / (int)S;
-                int s = idx % (int)S;
-                float a = cov[idx];
-                sumA += a;
-                sumX += a * (s + 0.5f);
-                sumY += a * (z + 0.5f);
-                /* 4-neighbors */
-                int nx, nz, nidx;
-                nx = s - 1;
-                nz = z;
-                if (nx >= 0)
-                {
-                    nidx = nz * (int)S + nx;
-                    if (!vis[nidx] && cov[nidx] > 0.0f)
-                    {
-                        vis[nidx] = 1;
-                        stack[sp++] = nidx;
-                    }
-                }
-                nx = s + 1;
-                nz = z;
-                if (nx < (int)S)
-                {
-                    nidx = nz * (int)S + nx;
-                    if (!vis[nidx] && cov[nidx] > 0.0f)
-                    {
-                        vis[nidx] = 1;
-                        stack[sp++] = nidx;
-                    }
-                }
-                nx = s;
-                nz = z - 1;
-                if (nz >= 0)
-                {
-                    nidx = nz * (int)S + nx;
-                    if (!vis[nidx] && cov[nidx] > 0.0f)
-                    {
-                        vis[nidx] = 1;
-                        stack[sp++] = nidx;
-                    }
-                }
-                nx = s;
-                nz = z + 1;
-                if (nz < (int)Z)
-                {
-                    nidx = nz * (int)S + nx;
-                    if (!vis[nidx] && cov[nidx] > 0.0f)
-                    {
-                        vis[nidx] = 1;
-                        stack[sp++] = nidx;
-                    }
-                }
-            }
-            if (sumA < 0.05f)
-                continue; /* ignore tiny noise */
-            dets[det_count].s = sumX / sumA;
-            dets[det_count].z = sumY / sumA;
-            det_count++;
+            comps[r].sumA += comps[id].sumA;
+            comps[r].sumX += comps[id].sumX;
+            comps[r].sumY += comps[id].sumY;
+        }
+    }
+
+    /* Emit the roots in raster order of their first pixel */
+    int nroots = 0;
+    for (int t = 0; t < nitems; ++t)
+    {
+        int base = t * band_rows * (int)TILE_DIM;
+        for (int id = base; id < base + ws.ncomp[t]; ++id)
+        {
+            comp_t *cp = &comps[id];
+            if (cp->parent != id || cp->sumA < 0.05f)
+                continue; /* merged into another component, or tiny noise */
+            ws.roots[nroots++] = (uint64_t)cp->first << 32 | (uint32_t)id;
         }
+    }
+    sort_keys(ws.roots, nroots);
+    int det_count = 0;
+    for (int i = 0; i < nroots; ++i)
+    {
+        comp_t *cp = &comps[(uint32_t)ws.roots[i]];
+        ws.dets[det_count].s = cp->sumX / cp->sumA;
+        ws.dets[det_count].z = cp->sumY / cp->sumA;
+        det_count++;
+    }
+    TRACE_END("labeling");
+    return det_count;
+}
+
+/* Edge-only cycle: scan the two-pixel border ring, report the outer
+   ring in `occupiedPixels` and track border blobs. Returns the crossings
+   completed in this frame (count in `*count`), or NULL if the workspace
+   could not be allocated. */
+static const edgeEvent_T *detect_edges(uint64_t frame, uint64_t ts, int *count)
+{
+    if (ws_reserve() != 0)
+        return NULL;
+
+    TRACE_BEGIN("ring scan");
+    int ring = edge_analytics_ring_size(ws.ea);
+    const edgePixel_T *pixels = edge_analytics_pixels(ws.ea);
+    ring_ctx_t rc = {pixels, ws.ring_cov};
+    tasks_parallel_for(ring, 16, ring_task, &rc);
+    int total = 0;
+    for (int i = 0; i < ring / 2; ++i)
+    {
+        if (ws.ring_cov[i] > 0)
+        {
+            occupiedPixels[total].s = pixels[i].s;
+            occupiedPixels[total].z = pixels[i].z;
+            occupiedPixels[total].coverage = ws.ring_cov[i];
+            total++;
+        }
+    }
+    numberOfOccupiedPixels = total;
+    TRACE_END("ring scan");
+
+    TRACE_BEGIN("edge tracking");
+    const edgeEvent_T *events = edge_analytics_update(ws.ea, ws.ring_cov, frame, ts, count);
+    TRACE_END("edge tracking");
+    return events;
+}
+
+/* Send a frame's crossing events to all output sinks */
+static void publish_events(const edgeEvent_T *events, int count)
+{
+    TRACE_BEGIN("publish");
+    for (int i = 0; i < num_sinks; ++i)
+    {
+        for (int j = 0; j < count; ++j)
+            sink_write_event(sinks[i], &events[j]);
+        sink_poll(sinks[i]);
+    }
+    TRACE_END("publish");
+}
+
+/* Publish a frame's detections to the detected-list, the shared-memory
+   feed and all output sinks */
+static void publish_frame(uint64_t frame, uint64_t ts, objectPosition_T *dets, int count)
+{
+    TRACE_BEGIN("publish");
+    setDetectedObjects(dets, count);
+    shm_feed_publish(frame, ts, dets, count);
+    for (int i = 0; i < num_sinks; ++i)
+        sink_write_frame(sinks[i], frame, ts, dets, count);
+    TRACE_END("publish");
+}
+
+#ifdef SURV_ALLOC_TEST
+/* Frames allowed to allocate before the loop counts as steady state.
+   Our own buffers are all reserved before the loop (ws_reserve(),
+   sink_open()); the first frame is exempt only for one-off allocations
+   that libraries such as ncurses make on first use. */
+#define SURV_ALLOC_WARMUP 1
+
+static unsigned long frame_alloc_begin(void)
+{
+    return alloc_count();
+}
+
+/* Abort if the frame that just finished touched the heap */
+static void frame_alloc_end(uint64_t frame, unsigned long before)
+{
+    unsigned long n = alloc_count() - before;
+    if (frame >= SURV_ALLOC_WARMUP && n > 0)
+    {
+        endwin();
+        fprintf(stderr, "frame %llu: %lu heap allocations in steady state\n",
+                (unsigned long long)frame, n);
+        abort();
+    }
+}
+#else
+static unsigned long frame_alloc_begin(void)
+{
+    return 0;
+}
+
+static void frame_alloc_end(uint64_t frame, unsigned long before)
+{
+    (void)frame;
+    (void)before;
+}
+#endif
+
+/* Interactive mode: detection loop with ncurses visualization */
+static void run_interactive(void)
+{
+    uint64_t frame = 0;
+
+    /* Initialize ncurses */
+    initscr();
+    cbreak();
+    noecho();
+    curs_set(0);
+    nodelay(stdscr, TRUE);
+    keypad(stdscr, TRUE);
 
-        free(cov);
-        free(vis);
-        free(stack);
+    /* Main loop: detect, publish and draw one frame per cycle */
+    while (keep_running && (max_frames == 0 || frame < max_frames))
+    {
+        unsigned long allocs = frame_alloc_begin();
+        uint64_t frame_ts = now_ns();
+        trace_set_frame(frame);
+        TRACE_BEGIN("frame");
+        int det_count = detect_frame();
+        if (det_count < 0)
+        {
+            TRACE_END("frame");
+            break; /* out of memory */
+        }
 
         /* Publish detections to the canonical detected-list */
-        setDetectedObjects(dets, det_count);
-        free(dets);
+        publish_frame(frame, frame_ts, ws.dets, det_count);
 
         /* Note: setDetectedObjects atomically updates `objectPositions` and `numberOfObjects` */
 
-        /* Visualization: draw full grid using check() results */
+        /* Visualization: draw the coverage grid sampled by this frame */
         int rows, cols;
         getmaxyx(stdscr, rows, cols);
         if ((int)Z + 6 + (int)numberOfObjects > rows || (int)S + 1 > cols)
@@ -317,6 +719,8 @@ int main(int argc, char **argv)
             mvprintw(0, 0, "Terminal too small: need at least %u cols x %u rows", S + 1, Z + 6 + numberOfObjects);
             mvprintw(1, 0, "Press 'q' or Ctrl-C to quit");
             refresh();
+            TRACE_END("frame");
+            frame_alloc_end(frame++, allocs);
             msleep(200);
             int ch = getch();
             if (ch == 'q' || ch == 'Q')
@@ -325,45 +729,142 @@ int main(int argc, char **argv)
         }
 
         /* Draw pixels */
-        for (unsigned int z = 0; z < Z; ++z)
+        TRACE_BEGIN("draw");
+        tileIter_T it;
+        tile_iter_init(&it, &ws.tiles, 0, ws.tiles.ntiles);
+        while (tile_iter_next(&it))
         {
-            for (unsigned int s = 0; s < S; ++s)
+            for (unsigned int lz = 0; lz < it.h; ++lz)
             {
-                coverage_T c = check(s, z);
-                int ch = cov_char(c);
-                mvaddch(z, s, ch);
+                const coverage_T *row = ws.grid + it.base + (lz << TILE_SHIFT);
+                for (unsigned int ls = 0; ls < it.w; ++ls)
+                    mvaddch(it.z0 + lz, it.s0 + ls, cov_char(row[ls]));
             }
         }
 
         /* Retrieve canonical detected objects and display them */
-        int max_objs = (int)(S * Z);
-        objectPosition_T *objs = malloc(sizeof(objectPosition_T) * (size_t)max_objs);
-        int n_objs = 0;
+        objectPosition_T *objs = ws.objs;
         int row = Z + 2;
-        if (objs)
+        int n_objs = getDetectedObjects(objs, (int)(S * Z));
+        for (int i = 0; i < n_objs; ++i)
         {
-            n_objs = getDetectedObjects(objs, max_objs);
-            for (int i = 0; i < n_objs; ++i)
-            {
-                int si = (int)roundf(objs[i].s);
-                int zi = (int)roundf(objs[i].z);
-                if (si >= 0 && si < (int)S && zi >= 0 && zi < (int)Z)
-                    mvaddch(zi, si, 'O' | A_BOLD);
-            }
-            mvprintw(Z + 1, 0, "Detected objects: %u", numberOfObjects);
-            for (int i = 0; i < n_objs && row < rows - 1; ++i)
-                mvprintw(row++, 0, "#%2d: x=%6.2f y=%6.2f", i, objs[i].s, objs[i].z);
-            free(objs);
+            int si = (int)roundf(objs[i].s);
+            int zi = (int)roundf(objs[i].z);
+            if (si >= 0 && si < (int)S && zi >= 0 && zi < (int)Z)
+                mvaddch(zi, si, 'O' | A_BOLD);
         }
-        else
+        mvprintw(Z + 1, 0, "Detected objects: %u", numberOfObjects);
+        for (int i = 0; i < n_objs && row < rows - 1; ++i)
+            mvprintw(row++, 0, "#%2d: x=%6.2f y=%6.2f", i, objs[i].s, objs[i].z);
+
+        mvprintw(row + 1, 0, "Press 'q' to quit.");
+        refresh();
+        TRACE_END("draw");
+        TRACE_END("frame");
+        frame_alloc_end(frame++, allocs);
+
+        /* Check for user input */
+        int ch = getch();
+        if (ch == 'q' || ch == 'Q')
+            break;
+
+        msleep(100); /* cycle delay */
+    }
+
+    endwin();
+}
+
+/* Number of recent crossings listed by the edge-only view */
+#define SURV_RECENT_EVENTS 5
+
+/* Interactive edge-only mode: border ring, counters and recent crossings */
+static void run_edge_interactive(void)
+{
+    uint64_t frame = 0;
+    edgeEvent_T recent[SURV_RECENT_EVENTS];
+    int nrecent = 0;
+
+    initscr();
+    cbreak();
+    noecho();
+    curs_set(0);
+    nodelay(stdscr, TRUE);
+    keypad(stdscr, TRUE);
+
+    while (keep_running && (max_frames == 0 || frame < max_frames))
+    {
+        unsigned long allocs = frame_alloc_begin();
+        uint64_t frame_ts = now_ns();
+        trace_set_frame(frame);
+        TRACE_BEGIN("frame");
+        int nev;
+        const edgeEvent_T *events = detect_edges(frame, frame_ts, &nev);
+        if (!events)
+        {
+            TRACE_END("frame");
+            break; /* out of memory or image too small */
+        }
+        publish_events(events, nev);
+
+        /* Keep the newest crossings, most recent first */
+        for (int i = 0; i < nev; ++i)
+        {
+            memmove(&recent[1], &recent[0], sizeof(edgeEvent_T) * (SURV_RECENT_EVENTS - 1));
+            recent[0] = events[i];
+            if (nrecent < SURV_RECENT_EVENTS)
+                nrecent++;
+        }
+
+        int rows, cols;
+        getmaxyx(stdscr, rows, cols);
+        int need_rows = (int)Z + 3 + EDGE_SIDE_COUNT + SURV_RECENT_EVENTS + 2;
+        if (need_rows > rows || (int)S + 1 > cols)
         {
-            mvprintw(Z + 1, 0, "Detected objects: %u", numberOfObjects);
+            clear();
+            mvprintw(0, 0, "Terminal too small: need at least %u cols x %d rows", S + 1, need_rows);
+            mvprintw(1, 0, "Press 'q' or Ctrl-C to quit");
+            refresh();
+            TRACE_END("frame");
+            frame_alloc_end(frame++, allocs);
+            msleep(200);
+            int ch = getch();
+            if (ch == 'q' || ch == 'Q')
+                break;
+            continue;
         }
 
+        /* Only the scanned ring is known; the interior stays blank */
+        TRACE_BEGIN("draw");
+        erase();
+        const edgePixel_T *pixels = edge_analytics_pixels(ws.ea);
+        int ring = edge_analytics_ring_size(ws.ea);
+        for (int i = 0; i < ring; ++i)
+            mvaddch(pixels[i].z, pixels[i].s, cov_char(ws.ring_cov[i]));
+
+        int row = Z + 1;
+        mvprintw(row++, 0, "Crossings per segment (in/out):");
+        unsigned int segments = edge_analytics_segments(ws.ea);
+        for (int e = 0; e < EDGE_SIDE_COUNT; ++e)
+        {
+            move(row++, 0);
+            printw("%-7s", edge_side_name((edgeSide_T)e));
+            for (unsigned int g = 0; g < segments; ++g)
+                printw(" %llu/%llu",
+                       (unsigned long long)edge_analytics_count(ws.ea, (edgeSide_T)e, g, EDGE_DIR_IN),
+                       (unsigned long long)edge_analytics_count(ws.ea, (edgeSide_T)e, g, EDGE_DIR_OUT));
+        }
+        for (int i = 0; i < nrecent; ++i)
+            mvprintw(row++, 0, "frame %llu: %s %s[%u] at %.2f",
+                     (unsigned long long)recent[i].frame,
+                     recent[i].direction == EDGE_DIR_IN ? "in " : "out",
+                     edge_side_name(recent[i].side), recent[i].segment, recent[i].pos);
+
         mvprintw(row + 1, 0, "Press 'q' to quit.");
         refresh();
+        TRACE_END("draw");
+        TRACE_END("frame");
+        frame_alloc_end(frame++, allocs);
 
-        /* Check for user input */
         int ch = getch();
         if (ch == 'q' || ch == 'Q')
             break;
@@ -372,8 +873,279 @@ int main(int argc, char **argv)
     }
 
     endwin();
+}
+
+/* Headless mode: same detection loop, results only go to the sinks */
+static void run_headless(void)
+{
+    uint64_t frame = 0;
+    while (keep_running && (max_frames == 0 || frame < max_frames))
+    {
+        unsigned long allocs = frame_alloc_begin();
+        uint64_t frame_ts = now_ns();
+        trace_set_frame(frame);
+        TRACE_BEGIN("frame");
+        if (edge_only)
+        {
+            int nev;
+            const edgeEvent_T *events = detect_edges(frame, frame_ts, &nev);
+            if (!events)
+            {
+                TRACE_END("frame");
+                break; /* out of memory or image too small */
+            }
+            publish_events(events, nev);
+        }
+        else
+        {
+            int det_count = detect_frame();
+            if (det_count < 0)
+            {
+                TRACE_END("frame");
+                break; /* out of memory */
+            }
+            publish_frame(frame, frame_ts, ws.dets, det_count);
+        }
+        TRACE_END("frame");
+        frame_alloc_end(frame++, allocs);
+        msleep(100); /* cycle delay */
+    }
+}
+
+/* Flush and close all sinks, reporting frames lost to slow consumers */
+static void close_sinks(void)
+{
+    for (int i = 0; i < num_sinks; ++i)
+    {
+        char name[256];
+        snprintf(name, sizeof(name), "%s", sink_name(sinks[i]));
+        uint64_t dropped = sink_close(sinks[i]);
+        if (dropped > 0)
+            fprintf(stderr, "Sink %s: %llu records dropped\n", name, (unsigned long long)dropped);
+    }
+    num_sinks = 0;
+}
+
+int main(int argc, char **argv)
+{
+    int demo_mode = 0;
+    int headless = 0;
+    const char *shm_name = NULL;
+    const char *sink_specs[SURV_MAX_SINKS];
+    int num_specs = 0;
+    sinkFormat_T sink_format = SINK_FORMAT_JSON;
+    unsigned int sink_batch = 16;
+    int num_threads = 0;
+    int pin_threads = 0;
+    const char *trace_path = NULL;
+    const char *scenario_path = NULL;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--demo") == 0)
+            demo_mode = 1;
+        else if (strcmp(argv[i], "--shm") == 0)
+            shm_name = SHM_FEED_DEFAULT_NAME;
+        else if (strncmp(argv[i], "--shm=", 6) == 0)
+            shm_name = argv[i] + 6;
+        else if (strcmp(argv[i], "--headless") == 0)
+            headless = 1;
+        else if (strcmp(argv[i], "--sink") == 0 && i + 1 < argc)
+        {
+            if (num_specs == SURV_MAX_SINKS)
+            {
+                fprintf(stderr, "At most %d sinks are supported\n", SURV_MAX_SINKS);
+                return 1;
+            }
+            sink_specs[num_specs++] = argv[++i];
+        }
+        else if (strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+        {
+            ++i;
+            if (strcmp(argv[i], "json") == 0)
+                sink_format = SINK_FORMAT_JSON;
+            else if (strcmp(argv[i], "binary") == 0)
+                sink_format = SINK_FORMAT_BINARY;
+            else
+            {
+                fprintf(stderr, "Unknown format %s (expected json or binary)\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+            sink_batch = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            num_threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--pin") == 0)
+            pin_threads = 1;
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            trace_path = argv[++i];
+        else if (strcmp(argv[i], "--pyramid") == 0 && i + 1 < argc)
+            sat_levels = (unsigned int)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc)
+            scenario_path = argv[++i];
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            max_frames = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--morton") == 0)
+            tile_morton = 1;
+        else if (strcmp(argv[i], "--edge-only") == 0)
+            edge_only = 1;
+        else if (strcmp(argv[i], "--edge-segments") == 0 && i + 1 < argc)
+        {
+            int n = atoi(argv[++i]);
+            edge_segments = n > 0 ? (unsigned int)n : 1;
+        }
+    }
+
+    /* Parse the scenario up front so a typo fails before anything starts */
+    scenario_T *scenario = NULL;
+    if (scenario_path)
+    {
+        char err[256];
+        scenario = scenario_load(scenario_path, err, sizeof(err));
+        if (!scenario)
+        {
+            fprintf(stderr, "Failed to load scenario: %s\n", err);
+            return 1;
+        }
+    }
+
+    /* A daemon without explicit sinks streams to stdout */
+    if (headless && num_specs == 0)
+        sink_specs[num_specs++] = "-";
+
+    signal(SIGINT, sigint_handler);
+    signal(SIGTERM, sigint_handler);
+    signal(SIGPIPE, SIG_IGN); /* broken sinks are reported through write errors */
+
+    /* Tracing starts first so the checker timer and workers are named */
+    if (trace_path)
+    {
+        if (trace_open(trace_path) != 0)
+        {
+            fprintf(stderr, "Failed to open trace file %s\n", trace_path);
+            scenario_free(scenario);
+            return 1;
+        }
+        trace_thread_name("main");
+    }
+
+    if (init() != 0)
+    {
+        fprintf(stderr, "Failed to initialize checker framework\n");
+        scenario_free(scenario);
+        return 1;
+    }
+
+    /* Worker pool for the full-frame stages */
+    if (tasks_init(num_threads, pin_threads) != 0)
+    {
+        fprintf(stderr, "Failed to start worker threads\n");
+        checker_shutdown();
+        scenario_free(scenario);
+        return 1;
+    }
+
+    /* Edge-only mode detects no objects, so there is nothing to publish */
+    if (edge_only && shm_name)
+    {
+        fprintf(stderr, "Shared-memory feed is not available with --edge-only\n");
+        shm_name = NULL;
+    }
+
+    /* Optionally publish detections to local consumer processes */
+    if (shm_name && shm_feed_open(shm_name, S, Z) != 0)
+    {
+        fprintf(stderr, "Failed to create shared-memory feed %s\n", shm_name);
+        tasks_shutdown();
+        checker_shutdown();
+        scenario_free(scenario);
+        return 1;
+    }
+
+    for (int i = 0; i < num_specs; ++i)
+    {
+        sinks[num_sinks] = sink_open(sink_specs[i], sink_format, sink_batch);
+        if (!sinks[num_sinks])
+        {
+            fprintf(stderr, "Failed to open sink %s\n", sink_specs[i]);
+            close_sinks();
+            shm_feed_close();
+            tasks_shutdown();
+            checker_shutdown();
+            scenario_free(scenario);
+            return 1;
+        }
+        num_sinks++;
+    }
+
+    /* Frame workspace, reallocated later only if the resolution changes */
+    if (ws_reserve() != 0)
+    {
+        if (edge_only)
+            fprintf(stderr, "Edge-only mode needs an image of at least 4x4 pixels\n");
+        else
+            fprintf(stderr, "Failed to allocate frame workspace\n");
+        close_sinks();
+        shm_feed_close();
+        tasks_shutdown();
+        checker_shutdown();
+        scenario_free(scenario);
+        return 1;
+    }
+
+    /* If demo mode is enabled, spawn a few objects coming in from edges */
+    if (demo_mode)
+    {
+        /* left -> right */
+        addObject(-0.5f, (float)Z * 0.25f, 0.6f, 0.0f);
+        /* right -> left */
+        addObject((float)S + 0.5f, (float)Z * 0.55f, -0.5f, 0.0f);
+        /* top -> down */
+        addObject((float)S * 0.33f, -0.5f, 0.0f, 0.5f);
+        /* bottom -> up */
+        addObject((float)S * 0.66f, (float)Z + 0.5f, 0.0f, -0.45f);
+    }
+
+    if (scenario && scenario_start(scenario) != 0)
+    {
+        fprintf(stderr, "Failed to start scenario thread\n");
+        scenario_free(scenario);
+        scenario = NULL;
+    }
+
+    if (headless)
+        run_headless();
+    else if (edge_only)
+        run_edge_interactive();
+    else
+        run_interactive();
+
+    /* Final line-crossing counters */
+    if (edge_only && ws.ea)
+    {
+        unsigned int segments = edge_analytics_segments(ws.ea);
+        for (int e = 0; e < EDGE_SIDE_COUNT; ++e)
+            for (unsigned int g = 0; g < segments; ++g)
+                fprintf(stderr, "Crossings %s[%u]: in=%llu out=%llu\n",
+                        edge_side_name((edgeSide_T)e), g,
+                        (unsigned long long)edge_analytics_count(ws.ea, (edgeSide_T)e, g, EDGE_DIR_IN),
+                        (unsigned long long)edge_analytics_count(ws.ea, (edgeSide_T)e, g, EDGE_DIR_OUT));
+    }
+
+    /* Stop injecting before the object list is torn down */
+    if (scenario)
+    {
+        fprintf(stderr, "Scenario injected %llu objects\n",
+                (unsigned long long)scenario_spawned(scenario));
+        scenario_free(scenario);
+    }
 
     /* Clean up checker framework */
+    close_sinks();
+    shm_feed_close();
+    tasks_shutdown();
+    ws_free();
     checker_shutdown();
+    trace_flush();
     return 0;
 }
@@ -0,0 +1,102 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+
+#include "shm_feed.h"
+
+/* Reference consumer of the shared-memory detection feed published by
+   `surv --shm`. Frames are evaluated in place inside the mapping and
+   only printed after the slot was validated. */
+
+static volatile sig_atomic_t keep_running = 1;
+
+static void sigint_handler(int sig)
+{
+    (void)sig;
+    keep_running = 0;
+}
+
+static void msleep(unsigned int ms)
+{
+    struct timespec ts = {.tv_sec = ms / 1000, .tv_nsec = (ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+int main(int argc, char **argv)
+{
+    const char *name = SHM_FEED_DEFAULT_NAME;
+    int verbose = 0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0)
+            verbose = 1;
+        else
+            name = argv[i];
+    }
+
+    signal(SIGINT, sigint_handler);
+    signal(SIGTERM, sigint_handler);
+
+    shmFeedReader_T r;
+    while (shm_feed_reader_open(&r, name) != 0)
+    {
+        if (!keep_running)
+            return 1;
+        fprintf(stderr, "Waiting for detection feed %s ...\n", name);
+        msleep(1000);
+    }
+    printf("Attached to %s (%ux%u)\n", name, r.hdr->S, r.hdr->Z);
+
+    while (keep_running)
+    {
+        uint64_t seq;
+        const shmFeedSlot_T *slot = shm_feed_begin_read(&r, &seq);
+        if (!slot)
+        {
+            msleep(10);
+            continue;
+        }
+
+        /* Evaluate the frame without copying it out of the mapping */
+        uint64_t frame = slot->frame;
+        uint64_t ts = slot->timestampNs;
+        uint32_t count = slot->count;
+        if (count > SHM_FEED_MAX_DETECTIONS)
+            count = SHM_FEED_MAX_DETECTIONS;
+        int truncated = slot->truncated != 0;
+        float sumS = 0.0f, sumZ = 0.0f;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            sumS += slot->detections[i].s;
+            sumZ += slot->detections[i].z;
+        }
+        objectPosition_T first[4];
+        uint32_t nFirst = count < 4 ? count : 4;
+        memcpy(first, slot->detections, sizeof(objectPosition_T) * nFirst);
+
+        if (!shm_feed_end_read(&r, slot, seq))
+            continue; /* overwritten while reading: discard */
+
+        printf("frame %llu t=%llu.%09llu objects=%u%s",
+               (unsigned long long)frame,
+               (unsigned long long)(ts / 1000000000ULL),
+               (unsigned long long)(ts % 1000000000ULL),
+               count, truncated ? "+" : "");
+        if (count > 0)
+            printf(" mean=(%.2f, %.2f)", sumS / count, sumZ / count);
+        if (verbose)
+            for (uint32_t i = 0; i < nFirst; ++i)
+                printf(" #%u=(%.2f, %.2f)", i, first[i].s, first[i].z);
+        printf(" lost=%llu\n", (unsigned long long)r.lost);
+        fflush(stdout);
+    }
+
+    shm_feed_reader_close(&r);
+    return 0;
+}
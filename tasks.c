@@ -0,0 +1,282 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE /* pthread_setaffinity_np */
+#endif
+
+#include "tasks.h"
+#include "trace.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Remaining items of one worker. The owner takes chunks from `lo`,
+   thieves split off the upper half. `gen` tags the loop the range
+   belongs to, so a late thief never takes items of the next loop. */
+typedef struct
+{
+    _Alignas(64) pthread_spinlock_t lock;
+    int lo;
+    int hi;
+    unsigned long gen;
+} tasksRange_T;
+
+static tasksRange_T *ranges = NULL;
+static pthread_t *threads = NULL;
+static int num_workers = 1;
+static int pin_workers = 0;
+
+/* Current loop */
+static tasksFn_T job_fn;
+static void *job_ctx;
+static int job_grain;
+static atomic_int job_remaining;
+
+/* Wake-up of idle workers and completion signalling */
+static pthread_mutex_t wake_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t done_cond = PTHREAD_COND_INITIALIZER;
+static unsigned long job_gen = 0;
+static int stopping = 0;
+
+/* CPUs the process may run on, captured by tasks_init() for --pin */
+static cpu_set_t pin_cpus;
+static int pin_ncpus = 0;
+static atomic_int pin_failed;
+
+/* Bind the calling thread to the worker-th allowed CPU (wrapping around) */
+static void pin_to_cpu(int worker)
+{
+    int nth = worker % pin_ncpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (!CPU_ISSET(cpu, &pin_cpus) || nth-- > 0)
+            continue;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (rc != 0 && !atomic_exchange(&pin_failed, 1))
+            fprintf(stderr, "Failed to pin worker %d to CPU %d: %s\n", worker, cpu, strerror(rc));
+        return;
+    }
+}
+
+/* Account for finished items; the last one wakes the caller */
+static void finish_items(int n)
+{
+    if (atomic_fetch_sub_explicit(&job_remaining, n, memory_order_acq_rel) == n)
+    {
+        pthread_mutex_lock(&wake_lock);
+        pthread_cond_broadcast(&done_cond);
+        pthread_mutex_unlock(&wake_lock);
+    }
+}
+
+/* Move the upper half of another worker's range into our own range.
+   Returns 1 if something was stolen. */
+static int steal(int self, unsigned long gen)
+{
+    for (int k = 1; k < num_workers; ++k)
+    {
+        tasksRange_T *v = &ranges[(self + k) % num_workers];
+        pthread_spin_lock(&v->lock);
+        if (v->gen != gen || v->hi - v->lo <= 0)
+        {
+            pthread_spin_unlock(&v->lock);
+            continue;
+        }
+        int avail = v->hi - v->lo;
+        int take = avail <= job_grain ? avail : avail / 2;
+        int hi = v->hi;
+        v->hi -= take;
+        pthread_spin_unlock(&v->lock);
+
+        tasksRange_T *own = &ranges[self];
+        pthread_spin_lock(&own->lock);
+        own->lo = hi - take;
+        own->hi = hi;
+        own->gen = gen;
+        pthread_spin_unlock(&own->lock);
+        return 1;
+    }
+    return 0;
+}
+
+/* Work on loop `gen` until no items are left anywhere */
+static void run_loop(int self, unsigned long gen)
+{
+    tasksRange_T *own = &ranges[self];
+    for (;;)
+    {
+        pthread_spin_lock(&own->lock);
+        if (own->gen == gen && own->lo < own->hi)
+        {
+            int b = own->lo;
+            int e = b + job_grain < own->hi ? b + job_grain : own->hi;
+            own->lo = e;
+            pthread_spin_unlock(&own->lock);
+            job_fn(b, e, job_ctx);
+            finish_items(e - b);
+            continue;
+        }
+        pthread_spin_unlock(&own->lock);
+        if (!steal(self, gen))
+            return;
+    }
+}
+
+static void *worker_main(void *arg)
+{
+    int self = (int)(long)arg;
+    if (pin_workers)
+        pin_to_cpu(self);
+    char name[32];
+    snprintf(name, sizeof(name), "worker %d", self);
+    trace_thread_name(name);
+
+    unsigned long seen = 0;
+    for (;;)
+    {
+        pthread_mutex_lock(&wake_lock);
+        while (!stopping && job_gen == seen)
+            pthread_cond_wait(&wake_cond, &wake_lock);
+        if (stopping)
+        {
+            pthread_mutex_unlock(&wake_lock);
+            return NULL;
+        }
+        seen = job_gen;
+        pthread_mutex_unlock(&wake_lock);
+        run_loop(self, seen);
+    }
+}
+
+int tasks_init(int threads_wanted, int pin)
+{
+    if (threads)
+        return -1;
+    if (threads_wanted <= 0)
+    {
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        threads_wanted = ncpu > 0 ? (int)ncpu : 1;
+    }
+
+    /* calloc() only guarantees 16-byte alignment; each range needs its own cache line */
+    void *block = NULL;
+    if (posix_memalign(&block, _Alignof(tasksRange_T), sizeof(tasksRange_T) * (size_t)threads_wanted) == 0)
+    {
+        memset(block, 0, sizeof(tasksRange_T) * (size_t)threads_wanted);
+        ranges = block;
+    }
+    threads = calloc((size_t)threads_wanted, sizeof(pthread_t));
+    if (!ranges || !threads)
+    {
+        free(ranges);
+        free(threads);
+        ranges = NULL;
+        threads = NULL;
+        return -1;
+    }
+    for (int i = 0; i < threads_wanted; ++i)
+        pthread_spin_init(&ranges[i].lock, PTHREAD_PROCESS_PRIVATE);
+
+    num_workers = threads_wanted;
+    pin_workers = 0;
+    if (pin)
+    {
+        /* Pin within the process' cpuset, which taskset or cgroups may restrict */
+        CPU_ZERO(&pin_cpus);
+        if (sched_getaffinity(0, sizeof(pin_cpus), &pin_cpus) == 0 && CPU_COUNT(&pin_cpus) > 0)
+        {
+            pin_ncpus = CPU_COUNT(&pin_cpus);
+            pin_workers = 1;
+        }
+        else
+            fprintf(stderr, "Failed to read the CPU affinity; workers are not pinned\n");
+    }
+    stopping = 0;
+    if (pin_workers)
+        pin_to_cpu(0);
+    for (int i = 1; i < num_workers; ++i)
+    {
+        if (pthread_create(&threads[i], NULL, worker_main, (void *)(long)i) != 0)
+        {
+            num_workers = i; /* run with the workers we got */
+            break;
+        }
+    }
+    return 0;
+}
+
+void tasks_parallel_for(int count, int grain, tasksFn_T fn, void *ctx)
+{
+    if (count <= 0)
+        return;
+    if (grain < 1)
+        grain = 1;
+    if (!ranges || num_workers == 1 || count <= grain)
+    {
+        fn(0, count, ctx);
+        return;
+    }
+
+    job_fn = fn;
+    job_ctx = ctx;
+    job_grain = grain;
+    atomic_store_explicit(&job_remaining, count, memory_order_relaxed);
+
+    /* seed every worker with an equal share of the range */
+    unsigned long gen = job_gen + 1;
+    int per = count / num_workers;
+    int rem = count % num_workers;
+    int base = 0;
+    for (int w = 0; w < num_workers; ++w)
+    {
+        int n = per + (w < rem ? 1 : 0);
+        pthread_spin_lock(&ranges[w].lock);
+        ranges[w].lo = base;
+        ranges[w].hi = base + n;
+        ranges[w].gen = gen;
+        pthread_spin_unlock(&ranges[w].lock);
+        base += n;
+    }
+
+    pthread_mutex_lock(&wake_lock);
+    job_gen = gen;
+    pthread_cond_broadcast(&wake_cond);
+    pthread_mutex_unlock(&wake_lock);
+
+    run_loop(0, gen);
+
+    pthread_mutex_lock(&wake_lock);
+    while (atomic_load_explicit(&job_remaining, memory_order_acquire) > 0)
+        pthread_cond_wait(&done_cond, &wake_lock);
+    pthread_mutex_unlock(&wake_lock);
+}
+
+int tasks_worker_count(void)
+{
+    return num_workers;
+}
+
+void tasks_shutdown(void)
+{
+    if (!threads)
+        return;
+    pthread_mutex_lock(&wake_lock);
+    stopping = 1;
+    pthread_cond_broadcast(&wake_cond);
+    pthread_mutex_unlock(&wake_lock);
+    for (int i = 1; i < num_workers; ++i)
+        pthread_join(threads[i], NULL);
+    for (int i = 0; i < num_workers; ++i)
+        pthread_spin_destroy(&ranges[i].lock);
+    free(ranges);
+    free(threads);
+    ranges = NULL;
+    threads = NULL;
+    num_workers = 1;
+}
@@ -0,0 +1,58 @@
+#ifndef TASKS_H
+#define TASKS_H
+
+/**
+ * @brief Body of a parallel loop.
+ *
+ * Processes the items [begin, end) of the loop.
+ *
+ * @param begin First item of the chunk
+ * @param end One past the last item of the chunk
+ * @param ctx User context passed to tasks_parallel_for()
+ */
+typedef void (*tasksFn_T)(int begin, int end, void *ctx);
+
+/**
+ * @brief Starts the shared worker pool.
+ *
+ * The thread calling tasks_parallel_for() takes part in the work as
+ * worker 0, so `threads - 1` additional threads are started.
+ *
+ * @param threads Number of workers including the caller; values
+ *                <= 0 select the number of online CPUs
+ * @param pin Non-zero to pin worker i to the i-th CPU the process may run
+ *            on (wrapping around); a failure is reported once on stderr
+ * @return 0 on success, non-zero on error
+ */
+int tasks_init(int threads, int pin);
+
+/**
+ * @brief Runs `fn` over the items [0, count) on all workers.
+ *
+ * The range is split evenly across the workers up front. Each worker
+ * takes chunks of `grain` items from the front of its own range; a
+ * worker that runs dry steals the back half of another worker's
+ * range, so expensive regions are rebalanced while the loop runs.
+ * Returns when all items are processed.
+ *
+ * Must only be called from one thread at a time and not from inside
+ * a task. Runs inline if the pool was not started.
+ *
+ * @param count Number of items
+ * @param grain Number of items claimed at once (>= 1)
+ * @param fn Loop body
+ * @param ctx User context passed to `fn`
+ */
+void tasks_parallel_for(int count, int grain, tasksFn_T fn, void *ctx);
+
+/**
+ * @brief Number of workers including the calling thread.
+ */
+int tasks_worker_count(void);
+
+/**
+ * @brief Stops and joins all worker threads.
+ */
+void tasks_shutdown(void);
+
+#endif /* TASKS_H */
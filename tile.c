@@ -0,0 +1,151 @@
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include "tile.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/* Size of an explicit huge page on x86-64 and most arm64 kernels */
+#define TILE_HUGE_PAGE (2u << 20)
+
+/* Interleave the bits of x (even positions) and y (odd positions) */
+static uint64_t morton_encode(uint32_t x, uint32_t y)
+{
+    uint64_t code = 0;
+    for (int b = 0; b < 32; ++b)
+    {
+        code |= (uint64_t)((x >> b) & 1u) << (2 * b);
+        code |= (uint64_t)((y >> b) & 1u) << (2 * b + 1);
+    }
+    return code;
+}
+
+static uint32_t morton_compact(uint64_t code)
+{
+    uint32_t v = 0;
+    for (int b = 0; b < 32; ++b)
+        v |= (uint32_t)((code >> (2 * b)) & 1u) << b;
+    return v;
+}
+
+int tile_layout_init(tileLayout_T *l, unsigned int cols, unsigned int rows, int morton)
+{
+    memset(l, 0, sizeof(*l));
+    l->S = cols;
+    l->Z = rows;
+    l->tilesS = (cols + TILE_DIM - 1) >> TILE_SHIFT;
+    l->tilesZ = (rows + TILE_DIM - 1) >> TILE_SHIFT;
+    l->ntiles = l->tilesS * l->tilesZ;
+    l->morton = morton;
+    l->slot = malloc(sizeof(uint32_t) * (l->ntiles ? l->ntiles : 1));
+    l->tile = malloc(sizeof(uint32_t) * (l->ntiles ? l->ntiles : 1));
+    if (!l->slot || !l->tile)
+    {
+        tile_layout_free(l);
+        return -1;
+    }
+
+    if (!morton)
+    {
+        for (unsigned int t = 0; t < l->ntiles; ++t)
+            l->slot[t] = l->tile[t] = t;
+        return 0;
+    }
+
+    /* Walk the Z-curve over the enclosing square and number the tiles
+       that exist in the order the curve reaches them */
+    uint32_t side = 1;
+    while (side < l->tilesS || side < l->tilesZ)
+        side <<= 1;
+    uint64_t codes = morton_encode(side - 1, side - 1) + 1;
+    uint32_t next = 0;
+    for (uint64_t c = 0; c < codes; ++c)
+    {
+        uint32_t ts = morton_compact(c);
+        uint32_t tz = morton_compact(c >> 1);
+        if (ts >= l->tilesS || tz >= l->tilesZ)
+            continue;
+        uint32_t t = tz * l->tilesS + ts;
+        l->slot[t] = next;
+        l->tile[next] = t;
+        next++;
+    }
+    return 0;
+}
+
+void tile_layout_free(tileLayout_T *l)
+{
+    free(l->slot);
+    free(l->tile);
+    l->slot = l->tile = NULL;
+    l->ntiles = 0;
+}
+
+void tile_iter_init(tileIter_T *it, const tileLayout_T *l, unsigned int begin, unsigned int end)
+{
+    it->layout = l;
+    it->next = begin;
+    it->end = end < l->ntiles ? end : l->ntiles;
+}
+
+int tile_iter_next(tileIter_T *it)
+{
+    if (it->next >= it->end)
+        return 0;
+    const tileLayout_T *l = it->layout;
+    it->slot = it->next++;
+    uint32_t t = l->tile[it->slot];
+    it->ts = t % l->tilesS;
+    it->tz = t / l->tilesS;
+    it->s0 = it->ts << TILE_SHIFT;
+    it->z0 = it->tz << TILE_SHIFT;
+    it->w = l->S - it->s0 < TILE_DIM ? l->S - it->s0 : TILE_DIM;
+    it->h = l->Z - it->z0 < TILE_DIM ? l->Z - it->z0 : TILE_DIM;
+    it->base = (size_t)it->slot * TILE_AREA;
+    return 1;
+}
+
+int tile_buffer_alloc(tileBuffer_T *b, size_t bytes)
+{
+    memset(b, 0, sizeof(*b));
+    if (bytes == 0)
+        bytes = 1;
+
+#ifdef MAP_HUGETLB
+    /* Explicit huge pages only pay off for blocks of at least one page */
+    if (bytes >= TILE_HUGE_PAGE)
+    {
+        size_t len = (bytes + TILE_HUGE_PAGE - 1) & ~((size_t)TILE_HUGE_PAGE - 1);
+        void *p = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+        {
+            b->data = p;
+            b->mapped = len;
+            b->hugetlb = 1;
+            return 0;
+        }
+    }
+#endif
+
+    void *p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        return -1;
+#ifdef MADV_HUGEPAGE
+    /* Ask for transparent huge pages; ignored where unsupported */
+    if (bytes >= TILE_HUGE_PAGE)
+        madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+    b->data = p;
+    b->mapped = bytes;
+    return 0;
+}
+
+void tile_buffer_free(tileBuffer_T *b)
+{
+    if (b->data)
+        munmap(b->data, b->mapped);
+    memset(b, 0, sizeof(*b));
+}
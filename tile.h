@@ -0,0 +1,130 @@
+#ifndef TILE_H
+#define TILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief log2 of the tile edge length.
+ */
+#define TILE_SHIFT 5
+
+/**
+ * @brief Tile edge length in pixels.
+ */
+#define TILE_DIM (1u << TILE_SHIFT)
+
+/**
+ * @brief Pixels per tile; a tile of 4-byte values fills one 4 KiB page.
+ */
+#define TILE_AREA (TILE_DIM * TILE_DIM)
+
+/**
+ * @brief Cache-blocked layout of an S x Z frame.
+ *
+ * The frame is cut into TILE_DIM x TILE_DIM tiles. Each tile is stored
+ * contiguously and row-major inside, so the vertical neighbor of a
+ * pixel is TILE_DIM elements away instead of a whole image row. Tiles
+ * at the right and bottom border are padded to full size. Tiles are
+ * stored in row-major tile order or, optionally, in Morton (Z-curve)
+ * order, which keeps tiles that are close in 2-D close in memory.
+ */
+typedef struct tileLayout_T
+{
+  unsigned int S;      /**< Columns of the frame */
+  unsigned int Z;      /**< Rows of the frame */
+  unsigned int tilesS; /**< Tiles per tile row */
+  unsigned int tilesZ; /**< Tiles per tile column */
+  unsigned int ntiles; /**< tilesS * tilesZ */
+  int morton;          /**< Non-zero if tiles are stored in Morton order */
+  uint32_t *slot;      /**< Storage slot of tile (ts, tz) at tz * tilesS + ts */
+  uint32_t *tile;      /**< Inverse of `slot` */
+} tileLayout_T;
+
+/**
+ * @brief Pixel rectangle of one tile, as produced by tile_iter_next().
+ */
+typedef struct tileIter_T
+{
+  const tileLayout_T *layout;
+  unsigned int next;   /**< Next slot to visit */
+  unsigned int end;    /**< One past the last slot to visit */
+  unsigned int slot;   /**< Storage slot of the current tile */
+  unsigned int ts, tz; /**< Tile coordinates of the current tile */
+  unsigned int s0, z0; /**< Frame position of its top-left pixel */
+  unsigned int w, h;   /**< Valid columns and rows (smaller at the border) */
+  size_t base;         /**< Element index of its first pixel */
+} tileIter_T;
+
+/**
+ * @brief Memory block holding tiled frame data.
+ *
+ * Backed by explicit huge pages when the block is large enough and the
+ * system has them reserved, otherwise by transparent huge pages where
+ * the kernel allows it, otherwise by ordinary pages.
+ */
+typedef struct tileBuffer_T
+{
+  void *data;    /**< Page-aligned start of the block */
+  size_t mapped; /**< Size of the mapping */
+  int hugetlb;   /**< Non-zero if backed by explicit huge pages */
+} tileBuffer_T;
+
+/**
+ * @brief Computes the layout of a frame.
+ *
+ * @param l Layout to initialize
+ * @param cols Columns of the frame
+ * @param rows Rows of the frame
+ * @param morton Store tiles in Morton order instead of row-major order
+ * @return 0 on success, -1 if memory is exhausted
+ */
+int tile_layout_init(tileLayout_T *l, unsigned int cols, unsigned int rows, int morton);
+
+/**
+ * @brief Releases the slot tables of a layout.
+ */
+void tile_layout_free(tileLayout_T *l);
+
+/**
+ * @brief Number of elements a tiled buffer of this layout holds.
+ */
+static inline size_t tile_elements(const tileLayout_T *l)
+{
+  return (size_t)l->ntiles * TILE_AREA;
+}
+
+/**
+ * @brief Element index of pixel (s, z) in a tiled buffer.
+ */
+static inline size_t tile_index(const tileLayout_T *l, unsigned int s, unsigned int z)
+{
+  size_t slot = l->slot[(z >> TILE_SHIFT) * l->tilesS + (s >> TILE_SHIFT)];
+  return slot * TILE_AREA + ((z & (TILE_DIM - 1)) << TILE_SHIFT) + (s & (TILE_DIM - 1));
+}
+
+/**
+ * @brief Prepares iteration over the tiles in storage slots [begin, end).
+ */
+void tile_iter_init(tileIter_T *it, const tileLayout_T *l, unsigned int begin, unsigned int end);
+
+/**
+ * @brief Advances to the next tile.
+ *
+ * @return 1 if `it` describes a tile, 0 when the range is exhausted
+ */
+int tile_iter_next(tileIter_T *it);
+
+/**
+ * @brief Allocates a zero-filled buffer for tiled data.
+ *
+ * @return 0 on success, -1 on error
+ */
+int tile_buffer_alloc(tileBuffer_T *b, size_t bytes);
+
+/**
+ * @brief Releases a buffer from tile_buffer_alloc(); safe on a zeroed buffer.
+ */
+void tile_buffer_free(tileBuffer_T *b);
+
+#endif /* TILE_H */
@@ -0,0 +1,158 @@
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Events kept per thread; older events are overwritten */
+#define TRACE_BUFFER_EVENTS (1u << 15)
+
+typedef struct
+{
+    const char *name;
+    uint64_t ts_ns;
+    uint64_t frame;
+    char phase; /* 'B' or 'E' */
+} traceEvent_T;
+
+/* Ring of events written only by its owning thread */
+typedef struct traceBuffer_T
+{
+    int tid;
+    char name[32];
+    _Atomic uint64_t count; /* events recorded so far */
+    struct traceBuffer_T *next;
+    traceEvent_T ev[TRACE_BUFFER_EVENTS];
+} traceBuffer_T;
+
+atomic_int trace_enabled = 0;
+
+static _Atomic(traceBuffer_T *) buffers = NULL;
+static atomic_int next_tid = 1;
+static _Atomic uint64_t current_frame = 0;
+static uint64_t start_ns = 0;
+static FILE *trace_file = NULL;
+
+static _Thread_local traceBuffer_T *self = NULL;
+
+static uint64_t mono_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Buffer of the calling thread, created and registered on first use */
+static traceBuffer_T *thread_buffer(void)
+{
+    if (self)
+        return self;
+    traceBuffer_T *b = calloc(1, sizeof(*b));
+    if (!b)
+        return NULL;
+    b->tid = atomic_fetch_add(&next_tid, 1);
+    snprintf(b->name, sizeof(b->name), "thread %d", b->tid);
+
+    /* lock-free push onto the list of all buffers */
+    traceBuffer_T *head = atomic_load(&buffers);
+    do
+        b->next = head;
+    while (!atomic_compare_exchange_weak(&buffers, &head, b));
+    self = b;
+    return b;
+}
+
+int trace_open(const char *path)
+{
+    trace_file = fopen(path, "w");
+    if (!trace_file)
+        return -1;
+    start_ns = mono_ns();
+    atomic_store(&trace_enabled, 1);
+    return 0;
+}
+
+void trace_set_frame(uint64_t frame)
+{
+    atomic_store_explicit(&current_frame, frame, memory_order_relaxed);
+}
+
+void trace_thread_name(const char *name)
+{
+    if (!atomic_load_explicit(&trace_enabled, memory_order_relaxed))
+        return;
+    traceBuffer_T *b = thread_buffer();
+    if (b)
+        snprintf(b->name, sizeof(b->name), "%s", name);
+}
+
+static void record(const char *name, char phase)
+{
+    traceBuffer_T *b = thread_buffer();
+    if (!b)
+        return;
+    uint64_t n = atomic_load_explicit(&b->count, memory_order_relaxed);
+    traceEvent_T *e = &b->ev[n % TRACE_BUFFER_EVENTS];
+    e->name = name;
+    e->ts_ns = mono_ns();
+    e->frame = atomic_load_explicit(&current_frame, memory_order_relaxed);
+    e->phase = phase;
+    atomic_store_explicit(&b->count, n + 1, memory_order_release);
+}
+
+void trace_begin(const char *name)
+{
+    record(name, 'B');
+}
+
+void trace_end(const char *name)
+{
+    record(name, 'E');
+}
+
+void trace_flush(void)
+{
+    if (!trace_file)
+        return;
+    atomic_store(&trace_enabled, 0);
+
+    fprintf(trace_file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    int first = 1;
+    traceBuffer_T *b = atomic_load(&buffers);
+    while (b)
+    {
+        fprintf(trace_file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", b->tid, b->name);
+        first = 0;
+
+        uint64_t count = atomic_load_explicit(&b->count, memory_order_acquire);
+        uint64_t from = count > TRACE_BUFFER_EVENTS ? count - TRACE_BUFFER_EVENTS : 0;
+        int depth = 0;
+        for (uint64_t i = from; i < count; ++i)
+        {
+            const traceEvent_T *e = &b->ev[i % TRACE_BUFFER_EVENTS];
+            /* the ring may start inside a stage: skip its unmatched end */
+            if (e->phase == 'E' && depth == 0)
+                continue;
+            depth += e->phase == 'B' ? 1 : -1;
+            uint64_t rel = e->ts_ns - start_ns;
+            fprintf(trace_file, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu.%03llu,\"pid\":1,\"tid\":%d,\"args\":{\"frame\":%llu}}",
+                    e->name, e->phase,
+                    (unsigned long long)(rel / 1000), (unsigned long long)(rel % 1000),
+                    b->tid, (unsigned long long)e->frame);
+        }
+
+        traceBuffer_T *next = b->next;
+        free(b);
+        b = next;
+    }
+    atomic_store(&buffers, NULL);
+    self = NULL;
+    fprintf(trace_file, "\n]}\n");
+    fclose(trace_file);
+    trace_file = NULL;
+}
@@ -0,0 +1,74 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/**
+ * @brief Non-zero while tracing is enabled.
+ *
+ * Checked inline by TRACE_BEGIN() / TRACE_END(), so disabled tracing
+ * costs one relaxed load and a predictable branch per probe.
+ */
+extern atomic_int trace_enabled;
+
+/**
+ * @brief Enables tracing to a Chrome trace-event JSON file.
+ *
+ * The file is written by trace_flush(); it can be loaded in
+ * chrome://tracing or ui.perfetto.dev.
+ *
+ * @param path Output file
+ * @return 0 on success, non-zero on error
+ */
+int trace_open(const char *path);
+
+/**
+ * @brief Sets the frame number attached to subsequent events.
+ */
+void trace_set_frame(uint64_t frame);
+
+/**
+ * @brief Names the calling thread in the trace (e.g. "worker 3").
+ */
+void trace_thread_name(const char *name);
+
+/**
+ * @brief Records the start of a stage on the calling thread.
+ *
+ * Events go to a per-thread buffer that only the owning thread writes,
+ * so recording never takes a lock. The buffer is a ring: once it is
+ * full, each new event overwrites the oldest one of that thread.
+ *
+ * @param name Stage name; must be a string literal or otherwise
+ *             outlive the trace
+ */
+void trace_begin(const char *name);
+
+/**
+ * @brief Records the end of the stage started last on the calling thread.
+ */
+void trace_end(const char *name);
+
+/**
+ * @brief Writes all recorded events to the trace file and disables tracing.
+ *
+ * Must be called after the traced threads stopped recording.
+ */
+void trace_flush(void);
+
+#define TRACE_BEGIN(name)                                                 \
+  do                                                                      \
+  {                                                                       \
+    if (atomic_load_explicit(&trace_enabled, memory_order_relaxed))       \
+      trace_begin(name);                                                  \
+  } while (0)
+
+#define TRACE_END(name)                                                   \
+  do                                                                      \
+  {                                                                       \
+    if (atomic_load_explicit(&trace_enabled, memory_order_relaxed))       \
+      trace_end(name);                                                    \
+  } while (0)
+
+#endif /* TRACE_H */